@@ -0,0 +1,393 @@
+import os
+import argparse
+import datetime
+import json
+import math
+import platform
+import shlex
+import subprocess
+import tempfile
+
+from configure import getDefaultBuilderDir
+
+# Runs C++ samples several times with DOCBUILDER_BENCH set and compares their results with the baseline.
+# Baselines are kept per host class (OS, architecture, CPU model and number of CPUs), because results of
+# different machines are not comparable. Every metric of every sample is compared with one-sided
+# Mann-Whitney U test: the metric regressed if the new values are greater (or less for throughput)
+# with p-value below `--alpha` and the median changed by more than `--threshold` percent.
+
+os_name = platform.system().lower()
+
+def mkdir(dir):
+    if not os.path.exists(dir):
+        os.makedirs(dir)
+
+def log(level, message):
+    print('bench.py: ' + level + ': ' + message)
+
+def getHostClass():
+    cpu = platform.processor()
+    if os_name == 'linux' and os.path.exists('/proc/cpuinfo'):
+        with open('/proc/cpuinfo', 'r') as file:
+            for line in file:
+                if line.startswith('model name'):
+                    cpu = line.split(':', 1)[1]
+                    break
+    cpu = '-'.join(''.join(c if c.isalnum() else ' ' for c in cpu.lower()).split())
+    parts = [os_name, platform.machine().lower(), cpu, str(os.cpu_count()) + 'cpu']
+    return '-'.join(part for part in parts if part)
+
+# results are stored as {workload: {metric: {"unit": unit, "values": [...]}}}
+def addResult(results, workload, metric, value, unit):
+    metrics = results.setdefault(workload, {})
+    result = metrics.setdefault(metric, {'unit': unit, 'values': []})
+    result['values'].append(value)
+
+def readResultsFile(results, path, workload=None):
+    with open(path, 'r') as file:
+        for line in file:
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                record = json.loads(line)
+            except ValueError:
+                log('warning', 'skipping invalid line in ' + path + ': ' + line)
+                continue
+            addResult(results, workload or record['sample'], record['metric'], record['value'], record['unit'])
+
+def logCacheSummary(results):
+    # hit rate and time saved by the output cache over all samples of the results, e.g. of a nightly run
+    lookups = 0
+    hits = 0
+    saved = 0.0
+    for metrics in results.values():
+        values = metrics.get('cache_hit', {}).get('values', [])
+        lookups += len(values)
+        hits += sum(1 for value in values if value > 0)
+        saved += sum(metrics.get('cache_time_saved', {}).get('values', []))
+    if lookups:
+        log('info', 'cache: %d of %d documents restored (%.0f%%), saved %.0f ms' % (hits, lookups, 100.0 * hits / lookups, saved))
+
+def parseWorkload(spec):
+    # "cpp/creating_invoice --chunk-size 500 data.json" -> ("creating_invoice", ["--chunk-size", "500", "data.json"])
+    args = shlex.split(spec)
+    test = args[0]
+    name = test.split('/')[-1]
+    if not os.path.isdir('cpp/' + name):
+        log('error', 'wrong test "' + test + '"')
+        exit(1)
+    return name, args[1:]
+
+def getBuildDir(variant):
+    # the same directories as in generated Makefile
+    return {'default': 'build', 'release': 'build_release'}.get(variant, 'build_pgo')
+
+def make(name, variant, target):
+    test_dir = 'out/cpp/' + name
+    if not os.path.exists(test_dir + '/Makefile'):
+        log('error', 'there is no Makefile for "' + name + '". Generate it with: python configure.py --make --test cpp/' + name)
+        exit(1)
+    if subprocess.call(['make', '-s', '-C', test_dir, 'VARIANT=' + variant, target]) != 0:
+        log('error', 'failed to make "' + target + '" of "' + name + '" (' + variant + ')')
+        exit(1)
+
+def buildSample(name, variant='default'):
+    make(name, variant, getBuildDir(variant) + '/' + name)
+
+def runWorkloads(workloads, repeat, builder_dir, variant='default'):
+    env = dict(os.environ)
+    lib_path = 'DYLD_LIBRARY_PATH' if os_name == 'darwin' else 'LD_LIBRARY_PATH'
+    env[lib_path] = builder_dir + (os.pathsep + env[lib_path] if env.get(lib_path) else '')
+    # cached documents would be measured instead of building them
+    env.pop('DOCBUILDER_CACHE_DIR', None)
+
+    results = {}
+    handle, output = tempfile.mkstemp(prefix='docbuilder_bench_', suffix='.jsonl')
+    os.close(handle)
+    env['DOCBUILDER_BENCH'] = output
+    try:
+        # workloads are interleaved, so slow drift of the machine affects all of them equally
+        for i in range(repeat):
+            for spec in workloads:
+                name, args = parseWorkload(spec)
+                log('info', variant + ' run ' + str(i + 1) + '/' + str(repeat) + ': ' + spec)
+                open(output, 'w').close()
+                with open(os.devnull, 'w') as devnull:
+                    code = subprocess.call([os.path.abspath('out/cpp/' + name + '/' + getBuildDir(variant) + '/' + name)] + args, cwd='out/cpp/' + name, env=env, stdout=devnull)
+                if code != 0:
+                    log('error', '"' + spec + '" exited with code ' + str(code))
+                    exit(1)
+                readResultsFile(results, output, spec if args else name)
+    finally:
+        os.remove(output)
+    return results
+
+def trainProfile(workloads, repeat, builder_dir):
+    # builds instrumented samples, runs the workloads to collect profiles and rebuilds the samples with them
+    names = sorted(set(parseWorkload(spec)[0] for spec in workloads))
+    for name in names:
+        pgo_dir = 'out/cpp/' + name + '/' + getBuildDir('pgo')
+        if os.path.isdir(pgo_dir):
+            for file_name in os.listdir(pgo_dir):
+                if file_name.endswith(('.gcda', '.profraw', '.profdata')):
+                    os.remove(pgo_dir + '/' + file_name)
+        buildSample(name, 'pgo-instrument')
+    runWorkloads(workloads, repeat, builder_dir, 'pgo-instrument')
+    for name in names:
+        make(name, 'pgo-instrument', 'pgo-merge')
+        buildSample(name, 'pgo')
+
+def prepareVariant(workloads, variant, builder_dir, train_repeat):
+    if variant == 'pgo':
+        trainProfile(workloads, train_repeat, builder_dir)
+        return
+    for name in sorted(set(parseWorkload(spec)[0] for spec in workloads)):
+        buildSample(name, variant)
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    return values[middle] if len(values) % 2 else (values[middle - 1] + values[middle]) / 2
+
+def mannWhitneyGreater(a, b):
+    # p-value of one-sided Mann-Whitney U test that values of `b` tend to be greater than values of `a`
+    # (normal approximation with tie and continuity corrections)
+    values = sorted([(value, 0) for value in a] + [(value, 1) for value in b])
+    n = len(values)
+    ranks_b = 0.0
+    ties = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j + 1 < n and values[j + 1][0] == values[i][0]:
+            j += 1
+        rank = (i + j) / 2.0 + 1
+        count = j - i + 1
+        ties += count ** 3 - count
+        ranks_b += rank * sum(1 for k in range(i, j + 1) if values[k][1] == 1)
+        i = j + 1
+    n_a = len(a)
+    n_b = len(b)
+    u = ranks_b - n_b * (n_b + 1) / 2.0
+    variance = n_a * n_b / 12.0 * ((n + 1) - ties / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (u - n_a * n_b / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+def getDirection(unit):
+    # 1 if greater values are worse, -1 if less values are worse, 0 if the metric is not compared
+    if unit in ('ms', 's', 'ns/call', 'KB', 'bytes'):
+        return 1
+    if unit.endswith('/s'):
+        return -1
+    return 0
+
+def compare(baseline, results, alpha, threshold, min_runs):
+    # returns rows (workload, metric, unit, baseline median, new median, change, p-value, status)
+    rows = []
+    for workload in sorted(set(baseline) | set(results)):
+        base_metrics = baseline.get(workload, {})
+        new_metrics = results.get(workload, {})
+        for metric in sorted(set(base_metrics) | set(new_metrics)):
+            base = base_metrics.get(metric)
+            new = new_metrics.get(metric)
+            if not new:
+                rows.append((workload, metric, base['unit'], median(base['values']), None, None, None, 'missing'))
+                continue
+            if not base:
+                rows.append((workload, metric, new['unit'], None, median(new['values']), None, None, 'new'))
+                continue
+            base_median = median(base['values'])
+            new_median = median(new['values'])
+            change = (new_median / base_median - 1) * 100 if base_median else 0.0
+            direction = getDirection(new['unit'])
+            p_value = None
+            status = 'ok'
+            if direction == 0:
+                status = 'info'
+            elif len(base['values']) < min_runs or len(new['values']) < min_runs:
+                status = 'too few runs'
+            else:
+                # the worse values are the greater ones after direction is applied
+                before, after = (base['values'], new['values']) if direction > 0 else (new['values'], base['values'])
+                p_worse = mannWhitneyGreater(before, after)
+                p_better = mannWhitneyGreater(after, before)
+                if p_worse < alpha and change * direction > threshold:
+                    status = 'regression'
+                    p_value = p_worse
+                elif p_better < alpha and -change * direction > threshold:
+                    status = 'improvement'
+                    p_value = p_better
+                else:
+                    p_value = min(p_worse, p_better)
+            rows.append((workload, metric, new['unit'], base_median, new_median, change, p_value, status))
+    return rows
+
+def formatNumber(value, digits=3):
+    if value is None:
+        return ''
+    return ('%.' + str(digits) + 'g') % value if abs(value) < 1000 else '%.0f' % value
+
+def formatChange(change):
+    return '' if change is None else '%+.1f%%' % change
+
+def formatMarkdown(rows, host_class):
+    lines = ['# Benchmark comparison for ' + host_class]
+    workload = None
+    for row in rows:
+        if row[0] != workload:
+            workload = row[0]
+            lines += ['', '## ' + workload, '',
+                      '| Metric | Unit | Baseline | New | Change | p-value | Status |',
+                      '|---|---|---:|---:|---:|---:|---|']
+        status = '**regression**' if row[7] == 'regression' else row[7]
+        lines.append('| ' + ' | '.join([row[1], row[2], formatNumber(row[3]), formatNumber(row[4]), formatChange(row[5]), formatNumber(row[6], 2), status]) + ' |')
+    return '\n'.join(lines) + '\n'
+
+def formatHtml(rows, host_class):
+    escape = lambda text: text.replace('&', '&amp;').replace('<', '&lt;').replace('>', '&gt;')
+    colors = {'regression': '#f8d0d0', 'improvement': '#d0f0d0'}
+    lines = ['<!DOCTYPE html>', '<html><head><meta charset="utf-8"><title>Benchmark comparison</title>',
+             '<style>table{border-collapse:collapse}td,th{border:1px solid #ccc;padding:2px 8px}td.n{text-align:right}</style>',
+             '</head><body>', '<h1>Benchmark comparison for ' + escape(host_class) + '</h1>']
+    workload = None
+    for row in rows:
+        if row[0] != workload:
+            if workload is not None:
+                lines.append('</table>')
+            workload = row[0]
+            lines += ['<h2>' + escape(workload) + '</h2>', '<table>',
+                      '<tr><th>Metric</th><th>Unit</th><th>Baseline</th><th>New</th><th>Change</th><th>p-value</th><th>Status</th></tr>']
+        style = ' style="background:' + colors[row[7]] + '"' if row[7] in colors else ''
+        cells = ['<td>' + escape(row[1]) + '</td>', '<td>' + escape(row[2]) + '</td>']
+        cells += ['<td class="n">' + text + '</td>' for text in [formatNumber(row[3]), formatNumber(row[4]), formatChange(row[5]), formatNumber(row[6], 2)]]
+        cells.append('<td>' + row[7] + '</td>')
+        lines.append('<tr' + style + '>' + ''.join(cells) + '</tr>')
+    if workload is not None:
+        lines.append('</table>')
+    lines.append('</body></html>')
+    return '\n'.join(lines) + '\n'
+
+def compareVariants(results, variants):
+    # returns rows (workload, [(median of total time, speedup over the first variant) for every variant])
+    rows = []
+    for workload in sorted(results[variants[0]]):
+        base = results[variants[0]][workload].get('total')
+        cells = []
+        for variant in variants:
+            total = results[variant].get(workload, {}).get('total')
+            if not base or not total:
+                cells.append(None)
+                continue
+            cells.append((median(total['values']), median(base['values']) / median(total['values'])))
+        rows.append((workload, cells))
+    return rows
+
+def formatVariants(rows, variants, html):
+    cell = lambda value: '' if value is None else '%.1f ms (%.2fx)' % value
+    if html:
+        escape = lambda text: text.replace('&', '&amp;').replace('<', '&lt;').replace('>', '&gt;')
+        lines = ['<!DOCTYPE html>', '<html><head><meta charset="utf-8"><title>Build variants</title></head><body>',
+                 '<h1>Total time of build variants</h1>', '<table border="1">',
+                 '<tr><th>Sample</th>' + ''.join('<th>' + variant + '</th>' for variant in variants) + '</tr>']
+        for workload, cells in rows:
+            lines.append('<tr><td>' + escape(workload) + '</td>' + ''.join('<td>' + cell(value) + '</td>' for value in cells) + '</tr>')
+        lines += ['</table>', '</body></html>']
+    else:
+        lines = ['# Total time of build variants', '',
+                 '| Sample | ' + ' | '.join(variants) + ' |',
+                 '|---|' + '---:|' * len(variants)]
+        for workload, cells in rows:
+            lines.append('| ' + workload + ' | ' + ' | '.join(cell(value) for value in cells) + ' |')
+    return '\n'.join(lines) + '\n'
+
+def writeReport(report, path):
+    if path:
+        with open(path, 'w') as file:
+            file.write(report)
+        log('info', 'report saved to ' + path)
+    else:
+        print(report)
+
+if __name__ == '__main__':
+    # go to root dir
+    file_dir = os.path.dirname(os.path.realpath(__file__))
+    os.chdir(file_dir + '/..')
+    # initialize argument parser
+    parser = argparse.ArgumentParser(description='Run benchmarks of C++ samples and compare them with the baseline')
+    parser.add_argument('-t', '--test', dest='workloads', action='append', default=[],
+                        help='sample to run with its arguments, e.g. "cpp/creating_invoice --chunk-size 500" (built with generated Makefile)')
+    parser.add_argument('-i', '--input', dest='inputs', action='append', default=[], help='use results file written by samples instead of running them')
+    parser.add_argument('-r', '--repeat', type=int, default=10, help='number of runs of every sample (default: 10)')
+    parser.add_argument('--host-class', default=getHostClass(), help='name of the baseline (default: ' + getHostClass() + ')')
+    parser.add_argument('--baseline-dir', default='out/bench', help='directory with baselines (default: out/bench)')
+    parser.add_argument('--save-baseline', action='store_true', help='save results as the new baseline instead of comparing')
+    parser.add_argument('--alpha', type=float, default=0.01, help='significance level of the test (default: 0.01)')
+    parser.add_argument('--threshold', type=float, default=5.0, help='minimal change of median in percent to report (default: 5)')
+    parser.add_argument('--min-runs', type=int, default=5, help='minimal number of values in both runs to compare them (default: 5)')
+    parser.add_argument('--report', help='write report to the file (.html or .md), Markdown is printed by default')
+    parser.add_argument('--dir', default=getDefaultBuilderDir(), help='specifies Document Builder directory')
+    parser.add_argument('--variant', choices=['default', 'release', 'pgo'], default='default',
+                        help='build variant of the samples, every variant has its own baseline (default: default)')
+    parser.add_argument('--compare-variants', help='comma-separated build variants to compare total time of samples instead of baseline, e.g. "default,release,pgo"')
+    parser.add_argument('--train-repeat', type=int, default=3, help='number of runs of every sample to collect profile for pgo variant (default: 3)')
+
+    args = parser.parse_args()
+
+    if not args.workloads and not args.inputs:
+        log('error', 'specify samples to run with --test or results files with --input')
+        exit(1)
+
+    if args.compare_variants:
+        variants = args.compare_variants.split(',')
+        for variant in variants:
+            if not variant in ('default', 'release', 'pgo'):
+                log('error', 'wrong variant "' + variant + '"')
+                exit(1)
+        if not args.workloads:
+            log('error', 'specify samples to run with --test')
+            exit(1)
+        variant_results = {}
+        for variant in variants:
+            prepareVariant(args.workloads, variant, args.dir, args.train_repeat)
+            variant_results[variant] = runWorkloads(args.workloads, args.repeat, args.dir, variant)
+        rows = compareVariants(variant_results, variants)
+        writeReport(formatVariants(rows, variants, args.report and args.report.endswith('.html')), args.report)
+        exit(0)
+
+    results = {}
+    for path in args.inputs:
+        readResultsFile(results, path)
+    if args.workloads:
+        prepareVariant(args.workloads, args.variant, args.dir, args.train_repeat)
+        for workload, metrics in runWorkloads(args.workloads, args.repeat, args.dir, args.variant).items():
+            results.setdefault(workload, {}).update(metrics)
+    logCacheSummary(results)
+
+    mkdir(args.baseline_dir)
+    baseline_path = args.baseline_dir + '/' + args.host_class + ('' if args.variant == 'default' else '-' + args.variant) + '.json'
+    if args.save_baseline:
+        with open(baseline_path, 'w') as file:
+            json.dump({'host_class': args.host_class, 'date': datetime.datetime.now().isoformat(), 'results': results}, file, indent=4)
+        log('info', 'baseline saved to ' + baseline_path)
+        exit(0)
+
+    if not os.path.exists(baseline_path):
+        log('warning', 'there is no baseline for "' + args.host_class + '". Save it with --save-baseline')
+        exit(0)
+    with open(baseline_path, 'r') as file:
+        baseline = json.load(file)['results']
+
+    rows = compare(baseline, results, args.alpha, args.threshold, args.min_runs)
+    if args.report and args.report.endswith('.html'):
+        report = formatHtml(rows, args.host_class)
+    else:
+        report = formatMarkdown(rows, args.host_class)
+    writeReport(report, args.report)
+
+    regressions = [row for row in rows if row[7] == 'regression']
+    for row in regressions:
+        log('error', 'regression of "' + row[1] + '" in ' + row[0] + ': ' + formatChange(row[5]) + ' (p = ' + formatNumber(row[6], 2) + ')')
+    exit(1 if regressions else 0)
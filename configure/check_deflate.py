@@ -0,0 +1,169 @@
+import os
+import argparse
+import random
+import shutil
+import subprocess
+import tempfile
+import zlib
+
+# Checks resources/utils/deflate.h against zlib. Streams are compressed by zlib with every level and
+# with Z_SYNC_FLUSH and Z_FULL_FLUSH between segments (so stored blocks follow Huffman blocks in the
+# middle of a byte), decompressed by NSDeflate::Inflate and compared with the source. Data compressed
+# by NSDeflate::Deflate is decompressed by zlib. Streams are decompressed both from memory and from
+# CInflateSource by small chunks. The check program is built with $CXX (c++ by default).
+
+root_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), '..'))
+
+check_source = r'''
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "resources/utils/deflate.h"
+
+static bool readFile(const char* path, std::vector<unsigned char>& data)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return false;
+	unsigned char chunk[65536];
+	size_t size;
+	while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		data.insert(data.end(), chunk, chunk + size);
+	fclose(file);
+	return true;
+}
+
+// decompresses zlib stream by small chunks, so that blocks and codes cross the chunk boundaries
+static bool inflateByChunks(const std::vector<unsigned char>& stream, std::vector<unsigned char>& output, size_t chunkSize)
+{
+	size_t pos = 2;
+	NSUtils::NSDeflate::CInflateSource source = [&stream, &pos](unsigned char* buffer, size_t size) {
+		size_t count = std::min(size, stream.size() - std::min(pos, stream.size()));
+		if (count)
+			memcpy(buffer, &stream[pos], count);
+		pos += count;
+		return count;
+	};
+	NSUtils::NSDeflate::CBitReader reader(source, chunkSize);
+	std::vector<unsigned char> buffer;
+	return stream.size() >= 2 && NSUtils::NSDeflate::InflateRaw(reader, buffer, [&output](const unsigned char* data, size_t size) {
+		output.insert(output.end(), data, data + size);
+		return true;
+	});
+}
+
+// arguments: triples of "inflate <stream> <expected>" or "deflate <source> <stream>"
+int main(int argc, char* argv[])
+{
+	int failed = 0;
+	for (int i = 1; i + 2 < argc; i += 3)
+	{
+		std::vector<unsigned char> input, output, expected;
+		bool ok = readFile(argv[i + 1], input);
+		if (strcmp(argv[i], "inflate") == 0)
+		{
+			ok = ok && readFile(argv[i + 2], expected) && NSUtils::NSDeflate::Inflate(input.empty() ? NULL : &input[0], input.size(), output) && output == expected;
+			output.clear();
+			ok = ok && inflateByChunks(input, output, 1 + i % 13) && output == expected;
+		}
+		else
+		{
+			NSUtils::NSDeflate::Deflate(input.empty() ? NULL : &input[0], input.size(), output);
+			FILE* file = fopen(argv[i + 2], "wb");
+			ok = ok && file && (output.empty() || fwrite(&output[0], 1, output.size(), file) == output.size());
+			if (file)
+				fclose(file);
+		}
+		if (!ok)
+		{
+			printf("FAIL %s %s\n", argv[i], argv[i + 1]);
+			failed++;
+		}
+	}
+	return failed ? 1 : 0;
+}
+'''
+
+def log(level, message):
+    print('check_deflate.py: ' + level + ': ' + message)
+
+def makeSegment(rand):
+    kind = rand.randrange(3)
+    size = rand.choice([0, 1, 7, 20, 100, 1000, 70000])
+    if kind == 0:
+        # incompressible data is written to stored blocks
+        return bytes(rand.getrandbits(8) for _ in range(size))
+    if kind == 1:
+        words = [b'<c r="A1">', b'<v>', b'12.5', b'</v>', b'</c>', b'#DIV/0!', b'\n']
+        return b''.join(rand.choice(words) for _ in range(size // 4))
+    return bytes([rand.randrange(4)]) * size
+
+def makeStreams(rand, count):
+    streams = []
+    for index in range(count):
+        level = index % 10
+        compressor = zlib.compressobj(level)
+        source = b''
+        stream = b''
+        for _ in range(rand.randint(1, 20)):
+            segment = makeSegment(rand)
+            source += segment
+            stream += compressor.compress(segment)
+            stream += compressor.flush(rand.choice([zlib.Z_SYNC_FLUSH, zlib.Z_FULL_FLUSH, zlib.Z_NO_FLUSH]))
+        stream += compressor.flush(zlib.Z_FINISH)
+        streams.append((source, stream))
+    return streams
+
+def writeFile(path, data):
+    with open(path, 'wb') as file:
+        file.write(data)
+
+def readFile(path):
+    with open(path, 'rb') as file:
+        return file.read()
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Check deflate.h against zlib')
+    parser.add_argument('-n', '--count', dest='count', type=int, default=200, help='number of streams (default: %(default)s)')
+    parser.add_argument('--seed', dest='seed', type=int, default=1, help='seed of random generator (default: %(default)s)')
+    args = parser.parse_args()
+
+    rand = random.Random(args.seed)
+    work_dir = tempfile.mkdtemp(prefix='check_deflate_')
+    try:
+        source_path = os.path.join(work_dir, 'check.cpp')
+        program_path = os.path.join(work_dir, 'check')
+        writeFile(source_path, check_source.encode('utf-8'))
+        compiler = os.environ.get('CXX', 'c++')
+        if subprocess.call([compiler, '-std=c++11', '-O1', '-I' + root_dir, source_path, '-o', program_path]) != 0:
+            log('error', 'failed to build the check program')
+            exit(1)
+
+        streams = makeStreams(rand, args.count)
+        commands = []
+        for index, (source, stream) in enumerate(streams):
+            base = os.path.join(work_dir, str(index))
+            writeFile(base + '.src', source)
+            writeFile(base + '.z', stream)
+            commands += ['inflate', base + '.z', base + '.src', 'deflate', base + '.src', base + '.out']
+        code = subprocess.call([program_path] + commands)
+
+        failed = 0
+        for index, (source, _) in enumerate(streams):
+            path = os.path.join(work_dir, str(index) + '.out')
+            try:
+                ok = zlib.decompress(readFile(path)) == source
+            except (OSError, zlib.error):
+                ok = False
+            if not ok:
+                log('error', 'zlib failed to decompress the output of Deflate for stream ' + str(index))
+                failed += 1
+
+        if code != 0 or failed:
+            log('error', 'check failed')
+            exit(1)
+        log('info', str(len(streams)) + ' streams are decompressed by Inflate and compressed by Deflate correctly')
+    finally:
+        shutil.rmtree(work_dir)
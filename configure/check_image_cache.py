@@ -0,0 +1,182 @@
+import os
+import argparse
+import functools
+import random
+import shutil
+import subprocess
+import tempfile
+import threading
+import time
+from http.server import SimpleHTTPRequestHandler, ThreadingHTTPServer
+
+# Checks resources/utils/image_cache.h against a local HTTP server. Images are served from a temporary
+# directory with a delay, so the downloads overlap only if they run concurrently. Pairs of images have
+# the same data under different URLs and must be stored once, a missing image must be reported as a
+# failure and passed on by its URL. Then the server is stopped and the same images must be served from
+# the cache without downloads. The check program is built with $CXX (c++ by default) and uses curl.
+
+root_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), '..'))
+
+check_source = r'''
+#include <cstdio>
+
+#include "resources/utils/image_cache.h"
+
+// arguments: URLs of images, the cache directory is set by DOCBUILDER_IMAGE_CACHE_DIR
+int main(int argc, char* argv[])
+{
+	NSUtils::CImagePrefetcher prefetcher;
+	for (int i = 1; i < argc; i++)
+		prefetcher.Add(argv[i]);
+
+	NSUtils::CBenchTimer bench("check_image_cache");
+	size_t failures = prefetcher.Fetch(bench);
+	printf("failures %d\n", (int)failures);
+	const std::vector<NSUtils::CBenchTimer::CMetric>& metrics = bench.GetMetrics();
+	for (size_t i = 0; i < metrics.size(); i++)
+		printf("metric %s %.0f\n", metrics[i].name.c_str(), metrics[i].value);
+	for (int i = 1; i < argc; i++)
+		printf("path %s %s\n", argv[i], prefetcher.Get(std::string(argv[i])).c_str());
+	return 0;
+}
+'''
+
+def log(level, message):
+    print('check_image_cache.py: ' + level + ': ' + message)
+
+class CountingHandler(SimpleHTTPRequestHandler):
+    lock = threading.Lock()
+    running = 0
+    max_running = 0
+    requests = 0
+    delay = 0.0
+
+    def do_GET(self):
+        cls = CountingHandler
+        with cls.lock:
+            cls.requests += 1
+            cls.running += 1
+            cls.max_running = max(cls.max_running, cls.running)
+        try:
+            time.sleep(cls.delay)
+            SimpleHTTPRequestHandler.do_GET(self)
+        finally:
+            with cls.lock:
+                cls.running -= 1
+
+    def log_message(self, format, *args):
+        pass
+
+def writeFile(path, data):
+    with open(path, 'wb') as file:
+        file.write(data)
+
+def readFile(path):
+    with open(path, 'rb') as file:
+        return file.read()
+
+# runs the check program, returns failures, metrics and paths by URL
+def fetch(program_path, cache_dir, urls):
+    env = dict(os.environ, DOCBUILDER_IMAGE_CACHE_DIR=cache_dir)
+    env.pop('DOCBUILDER_BENCH', None)
+    output = subprocess.check_output([program_path] + urls, env=env).decode('utf-8')
+    failures = -1
+    metrics = {}
+    paths = {}
+    for line in output.splitlines():
+        fields = line.split(' ')
+        if fields[0] == 'failures':
+            failures = int(fields[1])
+        elif fields[0] == 'metric':
+            metrics[fields[1]] = int(fields[2])
+        elif fields[0] == 'path':
+            paths[fields[1]] = fields[2]
+    return failures, metrics, paths
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Check image_cache.h against a local HTTP server')
+    parser.add_argument('-n', '--count', dest='count', type=int, default=16, help='number of images (default: %(default)s)')
+    parser.add_argument('--delay', dest='delay', type=float, default=0.2, help='delay of every response in seconds (default: %(default)s)')
+    parser.add_argument('--seed', dest='seed', type=int, default=1, help='seed of random generator (default: %(default)s)')
+    args = parser.parse_args()
+
+    if not shutil.which('curl'):
+        log('error', 'curl is not found')
+        exit(1)
+
+    rand = random.Random(args.seed)
+    work_dir = tempfile.mkdtemp(prefix='check_image_cache_')
+    server = None
+    try:
+        source_path = os.path.join(work_dir, 'check.cpp')
+        program_path = os.path.join(work_dir, 'check')
+        writeFile(source_path, check_source.encode('utf-8'))
+        compiler = os.environ.get('CXX', 'c++')
+        if subprocess.call([compiler, '-std=c++11', '-O1', '-I' + root_dir, source_path, '-o', program_path]) != 0:
+            log('error', 'failed to build the check program')
+            exit(1)
+
+        # every two images have the same data
+        serve_dir = os.path.join(work_dir, 'serve')
+        cache_dir = os.path.join(work_dir, 'cache')
+        os.mkdir(serve_dir)
+        images = {}
+        for index in range(args.count):
+            if index % 2 == 0:
+                data = bytes(rand.getrandbits(8) for _ in range(rand.randint(1, 100000)))
+            name = 'image' + str(index) + '.png'
+            writeFile(os.path.join(serve_dir, name), data)
+            images[name] = data
+
+        CountingHandler.delay = args.delay
+        server = ThreadingHTTPServer(('127.0.0.1', 0), functools.partial(CountingHandler, directory=serve_dir))
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        base_url = 'http://127.0.0.1:' + str(server.server_address[1]) + '/'
+        urls = [base_url + name for name in images]
+        # the same image by another URL
+        query_url = base_url + 'image0.png?size=large'
+        missing_url = base_url + 'missing.png'
+        all_urls = urls + [query_url, missing_url]
+
+        errors = []
+        def check(condition, message):
+            if not condition:
+                log('error', message)
+                errors.append(message)
+
+        failures, metrics, paths = fetch(program_path, cache_dir, all_urls)
+        check(failures == 1, 'missing image is expected to fail once, failures: ' + str(failures))
+        check(metrics.get('image_downloads') == len(urls) + 1, 'unexpected number of downloads: ' + str(metrics.get('image_downloads')))
+        check(metrics.get('image_cache_hits') == 0, 'unexpected cache hits in empty cache: ' + str(metrics.get('image_cache_hits')))
+        check(CountingHandler.max_running > 1, 'images were downloaded one by one')
+        check(paths.get(missing_url) == missing_url, 'missing image is expected to be passed by its URL, got ' + str(paths.get(missing_url)))
+        for url, name in zip(urls, images):
+            path = paths.get(url, url)
+            check(path != url and os.path.isfile(path) and readFile(path) == images[name], 'image ' + url + ' is not cached correctly')
+        for index in range(0, len(urls) - 1, 2):
+            check(paths.get(urls[index]) == paths.get(urls[index + 1]), 'images with the same data are stored twice: ' + urls[index] + ', ' + urls[index + 1])
+        check(paths.get(query_url) == paths.get(urls[0]), 'image with query is stored twice')
+        stored = [name for name in os.listdir(cache_dir) if not name.startswith('url_')]
+        check(len(stored) == (len(urls) + 1) // 2, 'unexpected files in the cache: ' + ', '.join(sorted(stored)))
+
+        # the cached images are used without the server
+        server.shutdown()
+        server.server_close()
+        server = None
+        requests = CountingHandler.requests
+        failures, metrics, offline_paths = fetch(program_path, cache_dir, all_urls)
+        check(failures == 1, 'only missing image is expected to fail offline, failures: ' + str(failures))
+        check(metrics.get('image_cache_hits') == len(urls) + 1, 'unexpected number of cache hits offline: ' + str(metrics.get('image_cache_hits')))
+        check(metrics.get('image_downloads') == 0, 'unexpected downloads offline: ' + str(metrics.get('image_downloads')))
+        check(CountingHandler.requests == requests, 'server was requested offline')
+        check(offline_paths == paths, 'cached images have changed offline')
+
+        if errors:
+            log('error', 'check failed')
+            exit(1)
+        log('info', str(len(all_urls)) + ' images are fetched concurrently, stored once by their data and used offline correctly')
+    finally:
+        if server:
+            server.shutdown()
+            server.server_close()
+        shutil.rmtree(work_dir)
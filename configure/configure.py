@@ -179,7 +179,7 @@ def genQtProjectsCPP(tests, builder_dir):
         }
         replacePlaceholders('configure/templates/cpp/template.pro', test_dir + '/' + test_name + '.pro', replacements)
 
-def genMakefileCPP(tests, builder_dir):
+def genMakefileCPP(tests, builder_dir, variant):
     if os_name == 'windows':
         log('warning', 'generating Makefile is not available on Windows')
         return
@@ -188,13 +188,27 @@ def genMakefileCPP(tests, builder_dir):
     compiler = ''
     lflags = ''
     env_lib_path = ''
+    # profile-guided optimization: GCC merges profiles of all runs itself, Clang writes raw profile of every run
+    pgo_generate = ''
+    pgo_use = ''
+    pgo_merge = ''
+    # GCC runs LTRANS jobs serially and warns about it unless their number is given, Clang doesn't accept "auto"
+    lto = ''
     if os_name == 'linux':
         compiler = 'g++'
+        lto = '-flto=auto'
         lflags = '-Wl,--unresolved-symbols=ignore-in-shared-libs'
         env_lib_path = 'LD_LIBRARY_PATH'
+        pgo_generate = '-fprofile-generate=$(PGO_DIR) -fprofile-update=atomic'
+        pgo_use = '-fprofile-use=$(PGO_DIR) -fprofile-correction -Wno-missing-profile'
+        pgo_merge = '@echo "profiles are merged by instrumented runs"'
     elif os_name == 'darwin':
         compiler = 'clang++'
+        lto = '-flto'
         env_lib_path = 'DYLD_LIBRARY_PATH'
+        pgo_generate = '-fprofile-instr-generate=$(PGO_DIR)/%p.profraw'
+        pgo_use = '-fprofile-instr-use=$(PGO_DIR)/default.profdata'
+        pgo_merge = 'xcrun llvm-profdata merge -output=$(PGO_DIR)/default.profdata $(PGO_DIR)/*.profraw'
     root_dir = os.getcwd()
     for test in tests:
         test_dir = 'out/' + test
@@ -211,11 +225,16 @@ def genMakefileCPP(tests, builder_dir):
             '[ROOT_DIR]': root_dir,
             '[COMPILER]': compiler,
             '[LFLAGS]': lflags,
-            '[ENV_LIB_PATH]': env_lib_path
+            '[ENV_LIB_PATH]': env_lib_path,
+            '[VARIANT]': variant,
+            '[LTO]': lto,
+            '[PGO_GENERATE]': pgo_generate,
+            '[PGO_USE]': pgo_use,
+            '[PGO_MERGE]': pgo_merge
         }
         replacePlaceholders('configure/templates/cpp/Makefile', test_dir + '/Makefile', replacements)
 
-def genCPP(projects, tests, builder_dir):
+def genCPP(projects, tests, builder_dir, variant):
     mkdir('out/cpp')
     # generate header with builder path
     if not os.path.exists('out/cpp/builder_path.h'):
@@ -231,9 +250,9 @@ def genCPP(projects, tests, builder_dir):
         genQtProjectsCPP(tests, builder_dir)
     # Makefile
     if projects['make']:
-        genMakefileCPP(tests, builder_dir)
+        genMakefileCPP(tests, builder_dir, variant)
 
-def genCS(projects, tests, builder_dir):
+def genCS(projects, tests, builder_dir, variant):
     mkdir('out/cs')
     # generate file with builder path
     if not os.path.exists('out/cs/Constants.cs'):
@@ -247,7 +266,7 @@ def genCS(projects, tests, builder_dir):
     else:
         log('warning', 'generating C# projects only available ' + ('on Windows ' if os_name != 'windows' else '') + 'with --vs')
 
-def genPY(projects, tests, builder_dir):
+def genPY(projects, tests, builder_dir, variant):
     mkdir('out/python')
     # generate file with builder path
     if not os.path.exists('out/python/constants.py'):
@@ -267,6 +286,8 @@ if __name__ == '__main__':
     parser.add_argument('--qt', action='store_true', help='create Qt (.pro) project files')
     parser.add_argument('--make', action='store_true', help='create Makefile')
     parser.add_argument('-t', '--test', dest='tests', action='append', help='specifies tests to generate project files', required=True)
+    parser.add_argument('--variant', choices=['default', 'release', 'pgo-instrument', 'pgo'], default='default',
+                        help='default build variant of Makefile: without optimization, optimized with LTO, or profile-guided (default: default)')
     parser.add_argument('-l', '--list', action=PrintTestsList, nargs=0, help='show list of available tests and exit')
 
     default_builder_dir = getDefaultBuilderDir()
@@ -296,4 +317,4 @@ if __name__ == '__main__':
     mkdir('out')
     handlers = {'cpp': genCPP, 'cs': genCS, 'python': genPY}
     for lang, tests in tests_selected.items():
-        handlers[lang](projects, tests, args.dir)
+        handlers[lang](projects, tests, args.dir, args.variant)
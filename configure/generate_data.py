@@ -0,0 +1,574 @@
+import os
+import argparse
+import datetime
+import json
+import math
+import random
+import time
+from json.encoder import encode_basestring as encode_string
+
+# Generates synthetic versions of resources/data/*.json at a chosen scale.
+# Every file has the same structure as the bundled one, but its arrays have `--scale` records.
+# Data are generated with a random generator seeded by `--seed` and the name of the file,
+# so the same arguments always produce the same files. Records are written to the file
+# as soon as they are generated, so the memory used doesn't depend on the scale.
+
+def mkdir(dir):
+    if not os.path.exists(dir):
+        os.makedirs(dir)
+
+def log(level, message):
+    print('generate_data.py: ' + level + ': ' + message)
+
+class JsonWriter:
+    # writes JSON formatted as bundled files (4 spaces indentation) without keeping it in memory
+    def __init__(self, file):
+        self.file = file
+        self.parts = []
+        self.first = [True]
+        self.indents = ['\n']
+        self.keys = {}
+        self.records = 0
+
+    def write(self, text):
+        self.parts.append(text)
+        if len(self.parts) >= 65536:
+            self.flush()
+
+    def flush(self):
+        self.file.write(''.join(self.parts))
+        self.parts = []
+
+    def indent(self, depth):
+        while len(self.indents) <= depth:
+            self.indents.append(self.indents[-1] + '    ')
+        return self.indents[depth]
+
+    def prefix(self, key):
+        depth = len(self.first) - 1
+        if depth == 0:
+            text = ''
+        elif self.first[-1]:
+            self.first[-1] = False
+            text = self.indent(depth)
+        else:
+            text = ',' + self.indent(depth)
+        if key is not None:
+            # keys are repeated in every record, so they are encoded once
+            encoded = self.keys.get(key)
+            if encoded is None:
+                encoded = self.keys[key] = encode_string(key) + ': '
+            text += encoded
+        self.write(text)
+
+    def beginObject(self, key=None):
+        self.prefix(key)
+        self.write('{')
+        self.first.append(True)
+
+    def beginArray(self, key=None):
+        self.prefix(key)
+        self.write('[')
+        self.first.append(True)
+
+    def end(self, bracket):
+        empty = self.first.pop()
+        if not empty:
+            self.write(self.indent(len(self.first) - 1))
+        self.write(bracket)
+
+    def endObject(self):
+        self.end('}')
+
+    def endArray(self):
+        self.end(']')
+
+    def value(self, key, value):
+        self.prefix(key)
+        if isinstance(value, str):
+            self.write(encode_string(value))
+        elif isinstance(value, bool) or not isinstance(value, int):
+            self.write(json.dumps(value))
+        else:
+            self.write(str(value))
+
+    def item(self, value):
+        self.value(None, value)
+        self.records += 1
+
+    def record(self, fields):
+        # array element of flat object, `fields` is list of (key, value) pairs
+        self.beginObject()
+        for key, value in fields:
+            self.value(key, value)
+        self.endObject()
+        self.records += 1
+
+# pools of values for generated records
+companies = ['BrightTech Solutions', 'Innovative Systems', 'GreenTech Innovations', 'EcoTech Solutions', 'Northwind Traders',
+             'Blue Harbor Logistics', 'Summit Analytics', 'Redwood Software', 'Silverline Consulting', 'Quantum Devices']
+company_types = ['LLC', 'Inc.', 'Ltd.', 'Corp.', 'GmbH']
+streets = ['Innovation Drive', 'Enterprise Blvd', 'Elm Street', 'Market Street', 'Oak Avenue', 'Lake Road', 'Hill Street']
+cities = ['San Francisco, CA 94103', 'New York, NY 10001', 'Los Angeles, CA 90001', 'Austin, TX 73301', 'Seattle, WA 98101',
+          'Boston, MA 02108', 'Chicago, IL 60601']
+first_names = ['John', 'Jane', 'Sophia', 'Michael', 'Emma', 'Dmitry', 'Olivia', 'Liam', 'Ava', 'Noah', 'Mia', 'James']
+last_names = ['Smith', 'Doe', 'Turner', 'Reynolds', 'Kovalev', 'Johnson', 'Brown', 'Garcia', 'Miller', 'Davis', 'Wilson']
+positions = ['Software Engineer', 'Data Analyst', 'Sales Director', 'Accounts Payable Manager', 'Product Manager',
+             'QA Engineer', 'Designer', 'DevOps Engineer']
+brands = ['HP', 'Logitech', 'Canon', 'Corsair', 'Samsung', 'Dell', 'Lenovo', 'Apple', 'Asus', 'Epson']
+products = ['ProBook Laptop', 'Mouse', 'Printer', 'Keyboard', 'Monitor', 'Docking Station', 'Webcam', 'Headset', 'Scanner', 'Router']
+statuses = ['In Stock', 'Reserved', 'Pending Delivery']
+services = ['Cloud Hosting Service - Monthly Plan', 'Additional Storage - 50GB', 'Business Analysis Service',
+            'Custom Software Development', 'Technical Support - Hour', 'Data Migration', 'Security Audit', 'User Training Session']
+questions = ['How would you rate our service?', 'Would you recommend us to your friends?', 'How easy was it to use our product?',
+             'How satisfied are you with the support?', 'How would you rate the price?', 'How fast was the delivery?']
+comments = {
+    1: ['Absolutely not, terrible.', 'Very disappointed.'],
+    2: ['Inconvenient interface.', 'Below expectations.'],
+    3: ['Average level.', 'Could be better.'],
+    4: ['Probably yes.', 'Good overall.'],
+    5: ['Excellent, I liked everything!', 'Perfect service.']
+}
+topics = ['sustainability', 'eco-friendly products', 'recycling technologies', 'automation', 'e-commerce growth',
+          'green technology', 'renewable energy', 'circular economy', 'smart packaging', 'electric vehicles']
+skills = ['Data Analysis', 'SQL', 'Python', 'C++', 'Statistics', 'Machine Learning', 'Project Management', 'Excel']
+soft_skills = ['Communication', 'Teamwork', 'Leadership', 'Time Management', 'Negotiation', 'Presentation']
+levels = ['Beginner', 'Intermediate', 'Advanced']
+benefits = ['health insurance (CareHealth Plan)', 'vacation days per year', 'sick leave days per year',
+            'annual bonus up to 10% of salary', 'gym membership', 'education budget', 'remote work']
+
+def choice(rng, pool):
+    return pool[int(rng.random() * len(pool))]
+
+def companyName(rng):
+    return choice(rng, companies) + ' ' + choice(rng, company_types)
+
+def personName(rng):
+    return choice(rng, first_names) + ' ' + choice(rng, last_names)
+
+def address(rng):
+    return str(rng.randint(1, 999)) + ' ' + choice(rng, streets) + ', ' + choice(rng, cities) + ', USA'
+
+def dateString(day, format='%Y-%m-%d'):
+    return (datetime.date(2024, 1, 1) + datetime.timedelta(days=day)).strftime(format)
+
+def datesRange(index, count, days=730):
+    # increasing dates spread over `days` days, so sizes beyond that give several records per day
+    return dateString(index * days // max(count, 1))
+
+def genInventory(w, rng, args):
+    w.beginObject()
+    w.beginArray('inventory')
+    for i in range(args.scale):
+        w.record([
+            ('item', choice(rng, brands) + ' ' + choice(rng, products) + ' ' + str(i + 1)),
+            ('quantity', rng.randint(0, 100)),
+            ('status', choice(rng, statuses))
+        ])
+    w.endArray()
+    w.endObject()
+
+def writeLines(w, rng, key, count):
+    # array of lines with description, quantity, unit price and total, returns sum of totals
+    subtotal = 0
+    w.beginArray(key)
+    for i in range(count):
+        quantity = rng.randint(1, 10)
+        unit_price = rng.randint(1, 200) * 50
+        subtotal += quantity * unit_price
+        w.record([
+            ('description', choice(rng, services)),
+            ('quantity', quantity),
+            ('unit_price', unit_price),
+            ('total', quantity * unit_price)
+        ])
+    w.endArray()
+    return subtotal
+
+def genInvoice(w, rng, args):
+    w.beginObject()
+    w.beginObject('invoice')
+    w.value('number', '2025-' + str(rng.randint(1, 999)).zfill(3))
+    w.value('date', dateString(rng.randint(366, 730)))
+    w.endObject()
+    w.beginObject('seller')
+    w.value('company_name', companyName(rng))
+    w.value('address', address(rng))
+    w.value('tin', str(rng.randint(100000000, 999999999)))
+    w.beginObject('bank_details')
+    w.value('bank_name', 'First National Bank')
+    w.value('account_number', str(rng.randint(1000000000, 9999999999)))
+    w.value('swift_code', 'FNBUS33')
+    w.endObject()
+    w.value('authorized_person', personName(rng))
+    w.value('position', choice(rng, positions))
+    w.endObject()
+    w.beginObject('buyer')
+    w.value('company_name', companyName(rng))
+    w.value('address', address(rng))
+    w.value('tin', str(rng.randint(100000000, 999999999)))
+    w.endObject()
+    subtotal = writeLines(w, rng, 'items', args.scale)
+    tax = subtotal // 5
+    w.beginObject('totals')
+    w.value('subtotal', subtotal)
+    w.value('tax', tax)
+    w.value('total_due', subtotal + tax)
+    w.endObject()
+    w.endObject()
+
+def genCommercialOffer(w, rng, args):
+    w.beginObject()
+    w.beginObject('offer')
+    w.value('number', '2025-' + str(rng.randint(1, 999)).zfill(3))
+    w.value('date', dateString(rng.randint(366, 700)))
+    w.endObject()
+    w.beginObject('seller')
+    w.value('company_name', companyName(rng))
+    w.value('address', address(rng))
+    w.value('tin', str(rng.randint(100000000, 999999999)))
+    w.beginObject('contact')
+    w.value('phone', '+1 555-' + str(rng.randint(100, 999)) + '-' + str(rng.randint(1000, 9999)))
+    w.value('email', 'sales@example.com')
+    w.endObject()
+    w.beginObject('authorized_person')
+    w.value('full_name', personName(rng))
+    w.value('position', choice(rng, positions))
+    w.endObject()
+    w.endObject()
+    w.beginObject('buyer')
+    w.value('company_name', companyName(rng))
+    w.value('address', address(rng))
+    w.value('contact_person', personName(rng))
+    w.value('email', 'buyer@example.com')
+    w.endObject()
+    subtotal = writeLines(w, rng, 'offer_details', args.scale)
+    discount = subtotal // 10
+    tax = (subtotal - discount) // 5
+    w.beginObject('totals')
+    w.value('subtotal', subtotal)
+    w.value('discount', discount)
+    w.value('tax', tax)
+    w.value('total', subtotal - discount + tax)
+    w.endObject()
+    w.beginObject('terms_and_conditions')
+    w.value('validity_period', dateString(rng.randint(700, 760)))
+    w.value('payment_terms', '50% advance, balance upon delivery')
+    w.value('delivery_terms', 'Free on Board (FOB)')
+    w.value('additional_notes', 'The project will commence within 10 business days after the advance payment.')
+    w.endObject()
+    w.endObject()
+
+def genUserFeedback(w, rng, args):
+    w.beginArray()
+    for i in range(args.scale):
+        w.beginObject()
+        w.value('user_id', 'U' + str(i + 1))
+        w.value('date', datesRange(i, args.scale))
+        w.beginArray('feedback')
+        for j in range(args.questions):
+            rating = rng.randint(1, 5)
+            w.beginObject()
+            w.value('question', questions[j % len(questions)])
+            w.beginObject('answer')
+            w.value('rating', rating)
+            w.value('comment', choice(rng, comments[rating]))
+            w.endObject()
+            w.endObject()
+        w.endArray()
+        w.endObject()
+        w.records += 1
+    w.endArray()
+
+# Yields shares of random total of the market (50-95%) split among `count` competitors by random weights.
+# The weights aren't kept: they are summed in the first pass and generated again by the same seed.
+# Shares are rounded down, so their sum never exceeds 100%, to as many decimal digits as needed
+# to keep two significant digits of the smallest possible share, so none of them is zero.
+def marketShares(rng, count):
+    total = rng.randint(50, 95)
+    seed = rng.random()
+    weights = random.Random(seed)
+    weightsSum = sum(weights.random() + 0.1 for _ in range(count))
+    digits = max(2, int(math.ceil(-math.log10(total * 0.1 / weightsSum))) + 2) if count else 2
+    scale = 10 ** digits
+    weights = random.Random(seed)
+    for _ in range(count):
+        share = math.floor(total * (weights.random() + 0.1) / weightsSum * scale) / scale
+        yield ('%.*f' % (digits, share)).rstrip('0').rstrip('.') + '%'
+
+def genCompetitors(w, rng, args):
+    w.beginObject()
+    w.beginArray('competitors')
+    shares = marketShares(rng, args.scale)
+    for i in range(args.scale):
+        w.beginObject()
+        w.value('name', choice(rng, companies) + ' ' + str(i + 1))
+        w.value('market_share', next(shares))
+        w.value('recent_funding', str(rng.randint(1, 100)) + ' million USD')
+        w.beginArray('products')
+        for j in range(rng.randint(1, 3)):
+            w.value(None, choice(rng, topics).capitalize() + ' ' + choice(rng, products))
+        w.endArray()
+        w.endObject()
+        w.records += 1
+    w.endArray()
+    w.endObject()
+
+def genSearchTrends(w, rng, args):
+    w.beginObject()
+    w.beginArray('search_trends')
+    for i in range(args.scale):
+        w.record([
+            ('topic', choice(rng, topics)),
+            ('growth', 'up ' + str(rng.randint(5, 60)) + '% over the last ' + str(rng.randint(1, 12)) + ' months')
+        ])
+    w.endArray()
+    w.endObject()
+
+def genMarket(w, rng, args):
+    w.beginObject()
+    w.beginObject('market')
+    w.value('size', str(rng.randint(1, 99) / 10) + ' billion USD')
+    w.value('growth_rate', str(rng.randint(1, 20)) + '% annually')
+    w.beginArray('trends')
+    for i in range(args.scale):
+        w.item(choice(rng, topics))
+    w.endArray()
+    w.endObject()
+    w.endObject()
+
+def genAudience(w, rng, args):
+    w.beginObject()
+    w.beginObject('social_trends')
+    w.beginArray('positive_feedback')
+    for i in range(args.scale):
+        w.item(choice(rng, topics))
+    w.endArray()
+    w.beginArray('negative_feedback')
+    for i in range(args.scale):
+        w.item(choice(rng, ['high cost', 'lack of awareness', 'limited availability', 'slow delivery']))
+    w.endArray()
+    w.endObject()
+    w.beginObject('demographics')
+    w.value('age_range', '25-45')
+    w.value('location', 'Urban areas')
+    w.value('income_level', 'Middle to high-income')
+    w.endObject()
+    w.endObject()
+
+def genFinancialModel(w, rng, args):
+    w.beginObject()
+    w.beginArray('profit_forecast')
+    for i in range(args.scale):
+        revenue = rng.randint(10, 50)
+        cost = rng.randint(3, revenue // 2)
+        expenses = rng.randint(1, (revenue - cost) // 2)
+        w.record([
+            ('year', str(2025 + i)),
+            ('revenue', str(revenue / 10) + ' million USD'),
+            ('cost_of_goods_sold', str(cost / 10) + ' million USD'),
+            ('gross_profit', str((revenue - cost) / 10) + ' million USD'),
+            ('operating_expenses', str(expenses / 10) + ' million USD'),
+            ('net_profit', str((revenue - cost - expenses) / 10) + ' million USD')
+        ])
+    w.endArray()
+    w.beginObject('break_even_analysis')
+    w.value('fixed_costs', '10000 USD')
+    w.value('selling_price_per_unit', '100 USD')
+    w.value('variable_cost_per_unit', '50 USD')
+    w.value('break_even_point', 200)
+    w.endObject()
+    w.beginArray('growth_rates')
+    for i in range(args.scale):
+        w.record([('year', str(2025 + i)), ('growth', str(rng.randint(5, 40)) + '%')])
+    w.endArray()
+    w.endObject()
+
+def genFinancialSystem(w, rng, args):
+    # totals are written before quarters, so the quarters are generated twice with the same state of generator
+    state = rng.getstate()
+    quarters = []
+    total_revenue = 0
+    total_expenses = 0
+    for i in range(args.scale):
+        revenue = rng.randint(10, 20) * 100000
+        expenses = rng.randint(5, 10) * 100000
+        total_revenue += revenue
+        total_expenses += expenses
+    rng.setstate(state)
+
+    w.beginObject()
+    w.value('year', 2024)
+    w.beginObject('financials')
+    w.value('total_revenue', total_revenue)
+    w.value('total_expenses', total_expenses)
+    w.value('net_profit', total_revenue - total_expenses)
+    w.beginArray('quarterly_data')
+    for i in range(args.scale):
+        revenue = rng.randint(10, 20) * 100000
+        expenses = rng.randint(5, 10) * 100000
+        w.record([
+            ('quarter', 'Q' + str(i % 4 + 1)),
+            ('revenue', revenue),
+            ('expenses', expenses),
+            ('net_profit', revenue - expenses)
+        ])
+    w.endArray()
+    w.value('r_d_expenses', total_expenses // 6)
+    w.value('marketing_expenses', total_expenses // 8)
+    w.endObject()
+    w.beginArray('achievements')
+    for i in range(args.scale):
+        w.item('Launch of the new product \'' + choice(rng, products) + ' ' + str(i + 1) + '\'')
+    w.endArray()
+    w.beginObject('plans')
+    w.beginArray('projects')
+    for i in range(args.scale):
+        w.record([('name', 'Development of ' + choice(rng, topics) + ' service'), ('deadline', dateString(rng.randint(731, 1095)))])
+    w.endArray()
+    w.beginArray('financial_goals')
+    for i in range(args.scale):
+        w.record([('goal', choice(rng, ['Revenue growth', 'Cost reduction', 'Margin growth'])), ('value', str(rng.randint(5, 30)) + '%')])
+    w.endArray()
+    w.beginArray('marketing_initiatives')
+    for i in range(args.scale):
+        w.item('Participation in ' + str(rng.randint(1, 10)) + ' international exhibitions')
+    w.endArray()
+    w.endObject()
+    w.endObject()
+
+def genDevelopmentPlan(w, rng, args):
+    w.beginObject()
+    w.beginObject('employee')
+    w.value('name', personName(rng))
+    w.value('position', choice(rng, positions))
+    w.value('department', 'Analytics Department')
+    w.endObject()
+    w.beginObject('competencies')
+    for key, pool in [('technical_skills', skills), ('soft_skills', soft_skills)]:
+        w.beginArray(key)
+        for i in range(args.scale):
+            w.record([('name', choice(rng, pool)), ('level', choice(rng, levels))])
+        w.endArray()
+    w.endObject()
+    w.beginArray('development_areas')
+    for i in range(args.scale):
+        w.item('Improving ' + choice(rng, skills) + ' proficiency')
+    w.endArray()
+    w.beginArray('goals_next_year')
+    for i in range(args.scale):
+        w.item('Improving ' + choice(rng, skills) + ' skills to ' + choice(rng, levels) + ' level')
+    w.endArray()
+    w.beginArray('resources')
+    for i in range(args.scale):
+        w.record([
+            ('name', 'Course \'' + choice(rng, skills) + '\''),
+            ('provider', choice(rng, ['Coursera', 'HR Department', 'Udemy'])),
+            ('duration', str(rng.randint(1, 6)) + ' months')
+        ])
+    w.endArray()
+    w.endObject()
+
+def genEmploymentAgreement(w, rng, args):
+    w.beginObject()
+    w.value('date', dateString(rng.randint(0, 365), '%d/%m/%Y'))
+    w.beginObject('employer')
+    w.value('name', companyName(rng))
+    w.value('address', address(rng))
+    w.endObject()
+    w.beginObject('employee')
+    w.value('full_name', personName(rng))
+    w.value('address', address(rng))
+    w.endObject()
+    w.beginObject('position_and_duties')
+    w.value('job_title', choice(rng, positions))
+    w.endObject()
+    w.beginObject('compensation')
+    w.value('salary', rng.randint(30, 150) * 100)
+    w.value('currency', 'USD')
+    w.value('frequency', 'per month')
+    w.value('type', 'gross')
+    w.endObject()
+    w.beginObject('probationary_period')
+    w.value('duration', str(rng.randint(1, 6)) + ' months')
+    w.value('terminate', '7 days')
+    w.endObject()
+    w.beginObject('work_conditions')
+    w.value('working_hours', '9:00 AM to 5:00 PM')
+    w.value('work_schedule', 'Monday to Friday')
+    w.beginArray('benefits')
+    for i in range(args.scale):
+        w.item(choice(rng, benefits))
+    w.endArray()
+    w.beginArray('other_terms')
+    for i in range(args.scale):
+        w.item('eligible for ' + str(rng.randint(1, 5)) + ' days per week')
+    w.endArray()
+    w.endObject()
+    w.beginObject('termination')
+    w.value('notice_period', '30 days')
+    w.endObject()
+    w.beginObject('governing_law')
+    w.value('jurisdiction', 'State of California, USA')
+    w.endObject()
+    w.endObject()
+
+def genInvestment(w, rng, args):
+    # the only array of the sample is the table of years
+    w.beginObject()
+    w.value('initial_amount', rng.randint(1, 100) * 100000)
+    w.value('return_rate', rng.randint(1, 20) / 100)
+    w.value('term', args.scale)
+    w.records = args.scale
+    w.endObject()
+
+generators = {
+    'commercial_offer_data': genCommercialOffer,
+    'crunchbase_api_response': genCompetitors,
+    'employment_agreement_data': genEmploymentAgreement,
+    'financial_model_data': genFinancialModel,
+    'financial_system_response': genFinancialSystem,
+    'google_trends_api_response': genSearchTrends,
+    'hrms_response': genDevelopmentPlan,
+    'ims_response': genInventory,
+    'investment_data': genInvestment,
+    'invoice_response': genInvoice,
+    'smi_api_response': genAudience,
+    'statista_api_response': genMarket,
+    'user_feedback_data': genUserFeedback
+}
+
+def generate(name, args):
+    path = args.out + '/' + name + '.json'
+    # the same seed gives independent data for every file
+    rng = random.Random(str(args.seed) + '/' + name)
+    start = time.time()
+    with open(path, 'w', encoding='utf-8', newline='\n') as file:
+        w = JsonWriter(file)
+        generators[name](w, rng, args)
+        w.write('\n')
+        w.flush()
+    size = os.path.getsize(path)
+    log('info', 'generated ' + path + ': ' + str(w.records) + ' records, ' + str(round(size / 1048576, 1)) + ' MB in ' + str(round(time.time() - start, 1)) + ' s')
+
+if __name__ == '__main__':
+    # go to root dir
+    file_dir = os.path.dirname(os.path.realpath(__file__))
+    os.chdir(file_dir + '/..')
+    # initialize argument parser
+    parser = argparse.ArgumentParser(description='Generate synthetic data files with the structure of resources/data/*.json')
+    parser.add_argument('-n', '--scale', type=int, default=10, help='number of records in every array (default: 10)')
+    parser.add_argument('-q', '--questions', type=int, default=2, help='number of questions for every user in user_feedback_data (default: 2)')
+    parser.add_argument('--seed', type=int, default=1, help='seed of random generator (default: 1)')
+    parser.add_argument('-o', '--out', default='out/data', help='output directory (default: out/data)')
+    parser.add_argument('-d', '--data', dest='names', action='append', choices=sorted(generators.keys()), help='generate only specified file (all files by default)')
+
+    args = parser.parse_args()
+
+    if args.scale < 0 or args.questions < 0:
+        log('error', 'sizes must not be negative')
+        exit(1)
+
+    mkdir(args.out)
+    for name in (args.names or sorted(generators.keys())):
+        generate(name, args)
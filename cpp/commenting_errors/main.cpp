@@ -16,12 +16,18 @@
  *
  */
 
+#include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 #include "common.h"
 #include "docbuilder.h"
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/xlsx_reader.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -29,47 +35,147 @@ using namespace NSDoctRenderer;
 const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.xlsx";
 
+// Error values of formulas
+struct CErrorToken
+{
+    const char* text;
+    size_t length;
+};
+
+const CErrorToken errorTokens[] = {
+    { "#DIV/0!", 7 },
+    { "#N/A", 4 },
+    { "#REF!", 5 },
+    { "#VALUE!", 7 },
+    { "#NAME?", 6 },
+    { "#NUM!", 5 },
+    { "#NULL!", 6 }
+};
+const int errorTokensCount = sizeof(errorTokens) / sizeof(errorTokens[0]);
+const size_t minErrorTokenLength = 4;
+
 // Helper functions
-void CheckCell(CValue worksheet, wstring cell, int row, int col)
+// Returns index of the first error token in UTF-8 `text`, or -1 if there is none.
+// Only the positions of '#' found by memchr() (which is vectorized in the C library) are compared with the tokens.
+int findErrorToken(const string& text)
 {
-    if (cell.find('#') != std::wstring::npos)
+    if (text.length() < minErrorTokenLength)
+        return -1;
+    const char* end = text.c_str() + text.length();
+    const char* hash = text.c_str();
+    while ((hash = (const char*)memchr(hash, '#', end - hash)) != NULL)
     {
-        wstring commentMsg = L"Error: " + cell;
-        CValue errorCell = worksheet.Call("GetRangeByNumber", row, col);
-        errorCell.Call("AddComment", commentMsg.c_str());
+        size_t rest = end - hash;
+        for (int i = 0; i < errorTokensCount; i++)
+        {
+            if (errorTokens[i].length <= rest && memcmp(hash, errorTokens[i].text, errorTokens[i].length) == 0)
+                return i;
+        }
+        hash++;
+    }
+    return -1;
+}
+
+// Reads the used range of the active sheet with the spreadsheet editor
+void readWithEditor(CValue worksheet, NSUtils::CXlsxRange& data)
+{
+    CValue values = worksheet.Call("GetUsedRange").Call("GetValue");
+    int sizeX = values.GetLength();
+    int sizeY = sizeX > 0 ? values[0].GetLength() : 0;
+    data = NSUtils::CXlsxRange(sizeX, sizeY);
+    for (int i = 0; i < sizeX; i++)
+    {
+        for (int j = 0; j < sizeY; j++)
+        {
+            wstring value = values[i][j].ToString().c_str();
+            data(i, j) = U_TO_UTF8(value);
+        }
     }
 }
 
 // Main function
 int main()
 {
+    NSUtils::CBenchTimer bench("commenting_errors");
+
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    bench.Phase("init");
 
     // Open file and get context
-    wstring templatePath = NSUtils::GetResourcesDirectory() + L"/docs/spreadsheet_with_errors.xlsx";
-    builder.OpenFile(templatePath.c_str(), L"");
+    string templatePath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/docs/spreadsheet_with_errors.xlsx";
+    builder.OpenFile(NSUtils::GetStringFromUtf8((const unsigned char*)templatePath.c_str(), templatePath.length()).c_str(), L"");
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
-
-    // Find and comment formula errors
     CValue worksheet = api.Call("GetActiveSheet");
-    CValue range = worksheet.Call("GetUsedRange");
-    CValue data = range.Call("GetValue");
+    bench.Phase("open");
 
-    for (int row = 0; row < (int)data.GetLength(); row++)
+    // Read values as UTF-8 bytes with the native reader, so no cell value is converted from JS.
+    // The editor is used only if the workbook can't be read natively.
+    NSUtils::CXlsxRange data;
+    size_t firstRow = 0;
+    size_t firstCol = 0;
+    NSUtils::CXlsxReader reader;
+    if (reader.Open(templatePath) && reader.GetUsedRange(data))
+    {
+        firstRow = reader.GetFirstRow();
+        firstCol = reader.GetFirstCol();
+    }
+    else
+    {
+        readWithEditor(worksheet, data);
+    }
+    bench.Phase("read");
+
+    // Find formula errors
+    struct CErrorCell
+    {
+        int row;
+        int col;
+        int token;
+    };
+    vector<CErrorCell> errorCells;
+    vector<int> errorCounts(errorTokensCount, 0);
+    for (size_t row = 0; row < data.GetRows(); row++)
     {
-        for (int col = 0; col < (int)data[0].GetLength(); col++)
+        for (size_t col = 0; col < data.GetCols(); col++)
         {
-            CheckCell(worksheet, data[row][col].ToString().c_str(), row, col);
+            int token = findErrorToken(data(row, col));
+            if (token < 0)
+                continue;
+            CErrorCell cell = { (int)(firstRow + row), (int)(firstCol + col), token };
+            errorCells.push_back(cell);
+            errorCounts[token]++;
         }
     }
+    bench.Phase("scan");
+
+    // Comment only the cells with errors
+    for (size_t i = 0; i < errorCells.size(); i++)
+    {
+        const CErrorCell& cell = errorCells[i];
+        string commentMsg = "Error: " + data(cell.row - firstRow, cell.col - firstCol);
+        CValue errorCell = worksheet.Call("GetRangeByNumber", cell.row, cell.col);
+        errorCell.Call("AddComment", commentMsg.c_str());
+    }
+    bench.Phase("comment");
+
+    // Report errors by type
+    printf("Checked %d cells, found %d errors\n", (int)(data.GetRows() * data.GetCols()), (int)errorCells.size());
+    for (int i = 0; i < errorTokensCount; i++)
+    {
+        if (errorCounts[i] == 0)
+            continue;
+        printf("  %-8s %d\n", errorTokens[i].text, errorCounts[i]);
+        bench.Add(string("errors ") + errorTokens[i].text, errorCounts[i], "cells");
+    }
 
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath);
+    bench.Phase("save");
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -21,6 +21,7 @@
 #include "docbuilder.h"
 
 #include "out/cpp/builder_path.h"
+#include "resources/utils/engine.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -99,8 +100,8 @@ void addTextFormToParagraph(CValue paragraph, CValue textForm, int fontSize, str
 int main()
 {
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
 
     CContext context = builder.GetContext();
@@ -178,6 +179,6 @@ int main()
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
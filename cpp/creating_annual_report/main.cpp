@@ -16,6 +16,7 @@
  *
  */
 
+#include <cstdio>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -25,28 +26,37 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/batch.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/export.h"
+#include "resources/utils/output_cache.h"
+#include "resources/utils/recorder.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
 using namespace NSDoctRenderer;
+using namespace NSUtils;
 using json = nlohmann::json;
 
 const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.docx";
 
 // Helper functions
-void addTextToParagraph(CValue paragraph, string text, int fontSize, bool isBold = false, string jc = "left")
+// All calls are made through CRecordedValue, so they can be recorded into a builder script.
+// Values from input JSON are passed as CRecordArg::FromData() to be referenced by `data` in the script.
+void addTextToParagraph(CRecordedValue paragraph, const CRecordArg& text, int fontSize, bool isBold = false, string jc = "left")
 {
-    paragraph.Call("AddText", text.c_str());
+    paragraph.Call("AddText", text);
     paragraph.Call("SetFontSize", fontSize);
     paragraph.Call("SetBold", isBold);
-    paragraph.Call("SetJc", jc.c_str());
+    paragraph.Call("SetJc", jc);
 }
 
-CValue createTable(CValue api, int rows, int cols, int borderColor = 200)
+CRecordedValue createTable(CRecordedValue api, int rows, int cols, int borderColor = 200)
 {
     // create table
-    CValue table = api.Call("CreateTable", cols, rows);
+    CRecordedValue table = api.Call("CreateTable", cols, rows);
     // set table properties;
     table.Call("SetWidth", "percent", 100);
     table.Call("SetTableCellMarginTop", 200);
@@ -61,197 +71,282 @@ CValue createTable(CValue api, int rows, int cols, int borderColor = 200)
     return table;
 }
 
-CValue getTableCellParagraph(CValue table, int row, int col)
+CRecordedValue getTableCellParagraph(CRecordedValue table, int row, int col)
 {
     return table.Call("GetCell", row, col).Call("GetContent").Call("GetElement", 0);
 }
 
-void fillTableHeaders(CValue table, const vector<string>& data, int fontSize)
+void fillTableHeaders(CRecordedValue table, const vector<string>& data, int fontSize)
 {
     for (int i = 0; i < (int)data.size(); i++)
     {
-        CValue paragraph = getTableCellParagraph(table, 0, i);
+        CRecordedValue paragraph = getTableCellParagraph(table, 0, i);
         addTextToParagraph(paragraph, data[i], fontSize, true);
     }
 }
 
-void fillTableBody(CValue table, const json& data, const vector<string>& keys, int fontSize, int startRow = 1)
+// fills table with rows of `data` array located at JSON `pointer`
+void fillTableBody(CRecordedValue table, const json& data, const string& pointer, const vector<string>& keys, int fontSize, int startRow = 1)
 {
-    for (int row = 0; row < (int)data.size(); row++)
+    int rowsCount = (int)GetJsonItem(data, pointer).size();
+    for (int row = 0; row < rowsCount; row++)
     {
         for (int col = 0; col < (int)keys.size(); col++)
         {
-            CValue paragraph = getTableCellParagraph(table, row + startRow, col);
-            const string& key = keys[col];
-            addTextToParagraph(paragraph, data[row][key].get<string>(), fontSize);
+            CRecordedValue paragraph = getTableCellParagraph(table, row + startRow, col);
+            string itemPointer = pointer + "/" + to_string(row) + "/" + keys[col];
+            addTextToParagraph(paragraph, CRecordArg::FromData(data, itemPointer), fontSize);
         }
     }
 }
 
-CValue createNumbering(CValue api, const json& data, string numberingType, int fontSize)
+// creates list from strings of `data` array located at JSON `pointer` and adds it to `content`
+CRecordedValue createNumbering(CRecordedValue api, CRecordedValue document, CDocumentBatch<CRecordedValue>& content, const json& data, const string& pointer, string numberingType, int fontSize)
 {
-    CValue document = api.Call("GetDocument");
-    CValue numbering = document.Call("CreateNumbering", numberingType.c_str());
-    CValue numberingLevel = numbering.Call("GetLevel", 0);
+    CRecordedValue numbering = document.Call("CreateNumbering", numberingType);
+    CRecordedValue numberingLevel = numbering.Call("GetLevel", 0);
 
-    CValue paragraph;
-    for (const auto& entry : data)
+    CRecordedValue paragraph;
+    int entriesCount = (int)GetJsonItem(data, pointer).size();
+    for (int i = 0; i < entriesCount; i++)
     {
         paragraph = api.Call("CreateParagraph");
         paragraph.Call("SetNumbering", numberingLevel);
-        addTextToParagraph(paragraph, entry.get<string>().c_str(), fontSize);
-        document.Call("Push", paragraph);
+        addTextToParagraph(paragraph, CRecordArg::FromData(data, pointer + "/" + to_string(i)), fontSize);
+        content.Add(paragraph);
     }
     // return the last paragraph in numbering
     return paragraph;
 }
 
-CValue createStringArray(const vector<string>& values)
+CRecordedValue createStringArray(CCallRecorder& recorder, const vector<string>& values)
 {
-    CValue arrResult = CValue::CreateArray((int)values.size());
-    for (int i = 0; i < (int)values.size(); i++)
-    {
-        arrResult[i] = values[i].c_str();
-    }
-
-    return arrResult;
+    return recorder.CreateArray(vector<CRecordArg>(values.begin(), values.end()));
 }
 
-CValue createIntegerArray(const vector<int>& values)
+// Paragraphs and tables are pushed to the document by batches, one per section, unless `batchPush` is false
+void buildReport(CCallRecorder& recorder, CRecordedValue api, const json& data, bool batchPush)
 {
-    CValue arrResult = CValue::CreateArray((int)values.size());
-    for (int i = 0; i < (int)values.size(); i++)
-    {
-        arrResult[i] = values[i];
-    }
-
-    return arrResult;
-}
-
-// Main function
-int main()
-{
-    // parse JSON
-    string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/financial_system_response.json";
-    ifstream fs(jsonPath);
-    json data = json::parse(fs);
-
-    // init docbuilder and create new docx file
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
-    builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
-
-    CContext context = builder.GetContext();
-    CValue global = context.GetGlobal();
-    CValue api = global["Api"];
-    CValue document = api.Call("GetDocument");
+    CRecordedValue document = api.Call("GetDocument");
+    CDocumentBatch<CRecordedValue> content(document, batchPush);
 
     // DOCUMENT HEADER
-    CValue paragraph = document.Call("GetElement", 0);
-    addTextToParagraph(paragraph, "Annual Report for " + to_string(data["year"].get<int>()), 44, true, "center");
+    CRecordedValue paragraph = document.Call("GetElement", 0);
+    addTextToParagraph(paragraph, CRecordArg("Annual Report for ") + CRecordArg::FromDataAsString(data, "/year"), 44, true, "center");
 
     // FINANCIAL section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Financial performance", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // quarterly data
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Quarterly data:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // chart
     paragraph = api.Call("CreateParagraph");
     vector<string> chartKeys = { "revenue", "expenses", "net_profit" };
-    const json& quarterlyData = data["financials"]["quarterly_data"];
-    CValue arrChartData = CValue::CreateArray((int)chartKeys.size());
+    int quartersCount = (int)data["financials"]["quarterly_data"].size();
+    vector<CRecordArg> chartData;
     for (int i = 0; i < (int)chartKeys.size(); i++)
     {
-        arrChartData[i] = CValue::CreateArray((int)quarterlyData.size());
-        for (int j = 0; j < (int)quarterlyData.size(); j++)
+        vector<CRecordArg> series;
+        for (int j = 0; j < quartersCount; j++)
         {
-            arrChartData[i][j] = quarterlyData[j][chartKeys[i]].get<int>();
+            series.push_back(CRecordArg::FromData(data, "/financials/quarterly_data/" + to_string(j) + "/" + chartKeys[i]));
         }
+        chartData.push_back(recorder.CreateArray(series));
     }
-    CValue arrChartNames = createStringArray({ "Revenue", "Expenses", "Net Profit" });
-    CValue arrHorValues = createStringArray({ "Q1", "Q2", "Q3", "Q4" });
-    CValue chart = api.Call("CreateChart", "lineNormal", arrChartData, arrChartNames, arrHorValues);
+    CRecordedValue arrChartData = recorder.CreateArray(chartData);
+    CRecordedValue arrChartNames = createStringArray(recorder, { "Revenue", "Expenses", "Net Profit" });
+    CRecordedValue arrHorValues = createStringArray(recorder, { "Q1", "Q2", "Q3", "Q4" });
+    CRecordedValue chart = api.Call("CreateChart", "lineNormal", arrChartData, arrChartNames, arrHorValues);
     chart.Call("SetSize", 170 * 36000, 90 * 36000);
     paragraph.Call("AddDrawing", chart);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // expenses
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Expenses:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // pie chart
     paragraph = api.Call("CreateParagraph");
-    int rdExpenses = data["financials"]["r_d_expenses"].get<int>();
-    int marketingExpenses = data["financials"]["marketing_expenses"].get<int>();
-    int totalExpenses = data["financials"]["total_expenses"];
-    arrChartData = CValue::CreateArray(1);
-    arrChartData[0] = createIntegerArray({ rdExpenses, marketingExpenses, totalExpenses - (rdExpenses + marketingExpenses) });
-    arrChartNames = createStringArray({ "Research and Development", "Marketing", "Other" });
-    chart = api.Call("CreateChart", "pie", arrChartData, CValue::CreateArray(0), arrChartNames);
+    CRecordArg rdExpenses = CRecordArg::FromData(data, "/financials/r_d_expenses");
+    CRecordArg marketingExpenses = CRecordArg::FromData(data, "/financials/marketing_expenses");
+    CRecordArg totalExpenses = CRecordArg::FromData(data, "/financials/total_expenses");
+    CRecordArg otherExpenses(totalExpenses.intValue - (rdExpenses.intValue + marketingExpenses.intValue));
+    otherExpenses.expr = totalExpenses.expr + " - (" + rdExpenses.expr + " + " + marketingExpenses.expr + ")";
+    arrChartData = recorder.CreateArray({ recorder.CreateArray({ rdExpenses, marketingExpenses, otherExpenses }) });
+    arrChartNames = createStringArray(recorder, { "Research and Development", "Marketing", "Other" });
+    chart = api.Call("CreateChart", "pie", arrChartData, recorder.CreateArray({}), arrChartNames);
     chart.Call("SetSize", 170 * 36000, 90 * 36000);
     paragraph.Call("AddDrawing", chart);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // year totals
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Year total numbers:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // table
-    CValue table = createTable(api, 2, 3);
+    CRecordedValue table = createTable(api, 2, 3);
     fillTableHeaders(table, { "Total revenue", "Total expenses", "Total net profit" }, 22);
     paragraph = getTableCellParagraph(table, 1, 0);
-    addTextToParagraph(paragraph, to_string(data["financials"]["total_revenue"].get<int>()), 22);
+    addTextToParagraph(paragraph, CRecordArg::FromDataAsString(data, "/financials/total_revenue"), 22);
     paragraph = getTableCellParagraph(table, 1, 1);
-    addTextToParagraph(paragraph, to_string(data["financials"]["total_expenses"].get<int>()), 22);
+    addTextToParagraph(paragraph, CRecordArg::FromDataAsString(data, "/financials/total_expenses"), 22);
     paragraph = getTableCellParagraph(table, 1, 2);
-    addTextToParagraph(paragraph, to_string(data["financials"]["net_profit"].get<int>()), 22);
-    document.Call("Push", table);
+    addTextToParagraph(paragraph, CRecordArg::FromDataAsString(data, "/financials/net_profit"), 22);
+    content.Add(table);
+    content.Flush();
 
     // ACHIEVEMENTS section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Achievements this year", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // list
-    createNumbering(api, data["achievements"], "numbered", 22);
+    createNumbering(api, document, content, data, "/achievements", "numbered", 22);
+    content.Flush();
 
     // PLANS section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Plans for the next year", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // projects
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Projects:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // table
-    const json& projects = data["plans"]["projects"];
-    table = createTable(api, (int)projects.size() + 1, 2);
+    table = createTable(api, (int)data["plans"]["projects"].size() + 1, 2);
     fillTableHeaders(table, { "Name", "Deadline" }, 22);
-    fillTableBody(table, projects, { "name", "deadline" }, 22);
-    document.Call("Push", table);
+    fillTableBody(table, data, "/plans/projects", { "name", "deadline" }, 22);
+    content.Add(table);
     // financial goals
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Financial goals:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // table
-    const json& goals = data["plans"]["financial_goals"];
-    table = createTable(api, (int)goals.size() + 1, 2);
+    table = createTable(api, (int)data["plans"]["financial_goals"].size() + 1, 2);
     fillTableHeaders(table, { "Goal", "Value" }, 22);
-    fillTableBody(table, goals, { "goal", "value" }, 22);
-    document.Call("Push", table);
+    fillTableBody(table, data, "/plans/financial_goals", { "goal", "value" }, 22);
+    content.Add(table);
     // marketing initiatives
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Marketing initiatives:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // list
-    createNumbering(api, data["plans"]["marketing_initiatives"], "bullet", 22);
+    createNumbering(api, document, content, data, "/plans/marketing_initiatives", "bullet", 22);
+    content.Flush();
+}
+
+// Main function
+// Usage: creating_annual_report [--record script.js | --replay script.js] [--export-all] [--no-batch] [data.json]
+//   --record     - build the report and save all the made calls as a builder script
+//   --replay     - execute the recorded script with the data bound to it;
+//                  if the script is missing or was recorded for data of another shape, it is recorded again
+//   --export-all - also save the report as PDF and PNG thumbnail
+//   --no-batch   - push every paragraph and table to the document with its own call
+int main(int argc, char* argv[])
+{
+    HandleExportHelper(argc, argv, workDir);
+    CBenchTimer bench("creating_annual_report");
+
+    string jsonPath = U_TO_UTF8(GetResourcesDirectory()) + "/data/financial_system_response.json";
+    string recordPath;
+    string replayPath;
+    bool exportAll = false;
+    bool batchPush = true;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (arg == "--export-all")
+            exportAll = true;
+        else if (arg == "--no-batch")
+            batchPush = false;
+        else
+            jsonPath = arg;
+    }
+
+    // the report built from the same data is taken from the cache, if it is enabled
+    COutputCache cache("creating_annual_report");
+    bool useCache = !exportAll && recordPath.empty() && replayPath.empty();
+    if (useCache)
+    {
+        cache.AddInput(jsonPath);
+        if (cache.Restore(resultPath, bench))
+            return 0;
+    }
+    else
+    {
+        COutputCache::Detach(resultPath);
+    }
+
+    // parse JSON
+    ifstream fs(jsonPath);
+    json data = json::parse(fs);
+    string shape = GetJsonShape(data);
+    bench.Phase("parse");
+
+    // init docbuilder and create new docx file
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
+    bench.Phase("init");
+
+    string script;
+    if (!replayPath.empty() && LoadRecordedScript(replayPath, shape, script))
+    {
+        // bind data and execute all the recorded calls at once
+        string command = "var data = " + data.dump(-1, ' ', true) + ";\n" + script;
+        if (!builder.ExecuteCommand(GetStringFromUtf8((const unsigned char*)command.c_str(), command.length()).c_str()))
+        {
+            fprintf(stderr, "Failed to execute recorded script: %s\n", replayPath.c_str());
+            builder.CloseFile();
+            engine.Dispose();
+            return 1;
+        }
+        bench.Add("boundary_crossings", 1, "count");
+    }
+    else
+    {
+        if (!replayPath.empty())
+            recordPath = replayPath;
+
+        CCallRecorder recorder(!recordPath.empty());
+        CContext context = builder.GetContext();
+        CValue global = context.GetGlobal();
+        buildReport(recorder, recorder.Wrap(global["Api"], "Api"), data, batchPush);
+        bench.Add("boundary_crossings", (double)recorder.GetCrossingsCount(), "count");
+
+        if (!recordPath.empty() && !recorder.Save(recordPath, shape))
+            fprintf(stderr, "Failed to save recorded script: %s\n", recordPath.c_str());
+    }
+    bench.Phase("build");
 
     // save and close
-    builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
+    bool saved = true;
+    if (exportAll)
+    {
+        // DOCX is saved first and then converted to PDF and thumbnail concurrently
+        vector<CExportFormat> formats = {
+            { OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath, L"" },
+            { OFFICESTUDIO_FILE_CROSSPLATFORM_PDF, L"result.pdf", L"" },
+            { OFFICESTUDIO_FILE_IMAGE, L"result.png", GetThumbnailParams() }
+        };
+        saved = ReportExportResults(ExportDocument(builder, formats), bench);
+    }
+    else
+    {
+        builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
+    }
+    bench.Phase("save");
     builder.CloseFile();
-    CDocBuilder::Dispose();
-    return 0;
+    engine.Dispose();
+    if (useCache && saved)
+        cache.Store(resultPath, bench.GetTotalMs());
+    // failed conversion must fail the run, so it isn't measured as a successful one
+    return saved ? 0 : 1;
 }
@@ -21,6 +21,7 @@
 #include "docbuilder.h"
 
 #include "out/cpp/builder_path.h"
+#include "resources/utils/engine.h"
 
 using namespace NSDoctRenderer;
 
@@ -56,8 +57,8 @@ void setTextFormProperties(CValue textForm, std::string key, std::string tip, bo
 int main()
 {
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
 
     CContext context = builder.GetContext();
@@ -88,6 +89,6 @@ int main()
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -23,6 +23,9 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/xlsx_reader.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -44,16 +47,11 @@ void addText(CValue api, int fontSize, string text, CValue slide, CValue shape,
     slide.Call("AddObject", shape);
 }
 
-// Main function
-int main()
+// Reads the used range of the active sheet with the spreadsheet editor
+bool readWithEditor(CDocBuilder& builder, const wstring& path, NSUtils::CXlsxRange& data)
 {
-    // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
-
-    // Read chart data from xlsx
-    wstring templatePath = NSUtils::GetResourcesDirectory() + L"/docs/chart_data.xlsx";
-    builder.OpenFile(templatePath.c_str(), L"");
+    if (builder.OpenFile(path.c_str(), L"") != 0)
+        return false;
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
@@ -62,21 +60,76 @@ int main()
 
     int sizeX = values.GetLength();
     int sizeY = values[0].GetLength();
-    vector<vector<wstring>> data(sizeX, vector<wstring>(sizeY));
+    data = NSUtils::CXlsxRange(sizeX, sizeY);
     for (int i = 0; i < sizeX; i++)
     {
         for (int j = 0; j < sizeY; j++)
         {
-            data[i][j] = values[i][j].ToString().c_str();
+            wstring value = values[i][j].ToString().c_str();
+            data(i, j) = U_TO_UTF8(value);
         }
     }
     builder.CloseFile();
+    return true;
+}
+
+// Usage: creating_chart_presentation [--editor-reader] [--read-only] [data.xlsx]
+//   --editor-reader - read the workbook with the spreadsheet editor instead of the native reader
+//   --read-only     - only read the workbook and report time and memory (for large workbooks)
+int main(int argc, char* argv[])
+{
+    NSUtils::CBenchTimer bench("creating_chart_presentation");
+    string xlsxPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/docs/chart_data.xlsx";
+    bool editorReader = false;
+    bool readOnly = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--editor-reader")
+            editorReader = true;
+        else if (arg == "--read-only")
+            readOnly = true;
+        else
+            xlsxPath = arg;
+    }
+
+    // Init DocBuilder
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    bench.Phase("init");
+
+    // Read chart data from xlsx
+    NSUtils::CXlsxRange data;
+    bool read = false;
+    if (editorReader)
+    {
+        read = readWithEditor(builder, NSUtils::GetStringFromUtf8((const unsigned char*)xlsxPath.c_str(), xlsxPath.length()), data);
+    }
+    else
+    {
+        NSUtils::CXlsxReader reader;
+        read = reader.Open(xlsxPath) && reader.GetUsedRange(data);
+    }
+    double readMs = bench.Phase("read");
+    bench.AddPeakMemory("peak_memory_after_read");
+    if (!read || data.GetRows() < 2 || data.GetCols() < 2)
+    {
+        fprintf(stderr, "Failed to read chart data from %s\n", xlsxPath.c_str());
+        engine.Dispose();
+        return 1;
+    }
+    printf("Read %d x %d cells in %.0f ms\n", (int)data.GetRows(), (int)data.GetCols(), readMs);
+    if (readOnly)
+    {
+        engine.Dispose();
+        return 0;
+    }
 
     // Create chart presentation
     builder.CreateFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX);
-    context = builder.GetContext();
-    global = context.GetGlobal();
-    api = global["Api"];
+    CContext context = builder.GetContext();
+    CValue global = context.GetGlobal();
+    CValue api = global["Api"];
     CValue presentation = api.Call("GetPresentation");
     CValue slide = presentation.Call("GetSlideByIndex", 0);
     slide.Call("RemoveAllObjects");
@@ -100,29 +153,13 @@ int main()
     addText(api, 80, titleContent, slide, shapeTitle, paragraphTitle, fill, "center");
     addText(api, 42, textContent, slide, shapeText, paragraphText, fill, "left");
 
-    // Transform 2d array into cols names, rows names and data
-    CValue cols = context.CreateArray(sizeY - 1);
-    for (int col = 1; col < sizeY; col++)
-    {
-        cols[col - 1] = data[0][col].c_str();
-    }
-
-    CValue rows = context.CreateArray(sizeX - 1);
-    for (int row = 1; row < sizeX; row++)
-    {
-        rows[row - 1] = data[row][0].c_str();
-    }
-
-    CValue vals = context.CreateArray(sizeY - 1);
-    for (int row = 1; row < sizeY; row++)
-    {
-        CValue row_data = context.CreateArray(sizeX - 1);
-        for (int col = 1; col < sizeX; col++)
-        {
-            row_data[col - 1] = data[col][row].c_str();
-        }
-        vals[row - 1] = row_data;
-    }
+    // Split 2d array into cols names (first row), rows names (first column) and data.
+    // Series of the chart are columns of the sheet, so the data is passed transposed.
+    NSUtils::CMatrixView<string> sheet = data.GetView();
+    CValue cols = NSUtils::ToValue(context, sheet.GetRow(0).GetTail(1));
+    CValue rows = NSUtils::ToValue(context, sheet.GetColumn(0).GetTail(1));
+    CValue vals = NSUtils::ToValue(context, sheet.GetSubView(1, 1).GetTransposed());
+    bench.Phase("convert");
 
     // Pass CValue data to the CreateChart method
     CValue chart = api.Call("CreateChart", "lineStacked", vals, cols, rows);
@@ -133,9 +170,13 @@ int main()
     chart.Call("SetLegendPos", "top");
     slide.Call("AddObject", chart);
 
+    bench.Phase("build");
+
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX, resultPath);
+    bench.Phase("save");
+    bench.AddPeakMemory("peak_memory");
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -25,6 +25,10 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/batch.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/output_cache.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
@@ -88,9 +92,9 @@ void fillTableBody(CValue table, const json& data, const vector<string>& keys, i
     }
 }
 
-CValue createNumbering(CValue api, const json& data, string numberingType, int fontSize)
+// creates list from strings of `data` and adds it to `content`
+CValue createNumbering(CValue api, CValue document, NSUtils::CDocumentBatch<CValue>& content, const json& data, string numberingType, int fontSize)
 {
-    CValue document = api.Call("GetDocument");
     CValue numbering = document.Call("CreateNumbering", numberingType.c_str());
     CValue numberingLevel = numbering.Call("GetLevel", 0);
 
@@ -100,29 +104,51 @@ CValue createNumbering(CValue api, const json& data, string numberingType, int f
         paragraph = api.Call("CreateParagraph");
         paragraph.Call("SetNumbering", numberingLevel);
         addTextToParagraph(paragraph, entry.get<string>().c_str(), fontSize);
-        document.Call("Push", paragraph);
+        content.Add(paragraph);
     }
     // return the last paragraph in numbering
     return paragraph;
 }
 
 // Main function
-int main()
+// Usage: creating_development_plan [--no-batch] [data.json]
+//   --no-batch - push every paragraph and table to the document with its own call instead of one batch per section
+int main(int argc, char* argv[])
 {
-    // parse JSON
+    NSUtils::CBenchTimer bench("creating_development_plan");
     string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/hrms_response.json";
+    bool batchPush = true;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--no-batch")
+            batchPush = false;
+        else
+            jsonPath = arg;
+    }
+
+    // the plan built from the same data is taken from the cache, if it is enabled
+    NSUtils::COutputCache cache("creating_development_plan");
+    cache.AddInput(jsonPath);
+    if (cache.Restore(resultPath, bench))
+        return 0;
+
+    // parse JSON
     ifstream fs(jsonPath);
     json data = json::parse(fs);
+    bench.Phase("parse");
 
     // init docbuilder and create new docx file
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
 
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
     CValue document = api.Call("GetDocument");
+    NSUtils::CDocumentBatch<CValue> content(document, batchPush);
+    bench.Phase("init");
 
     // TITLE PAGE
     // header
@@ -133,94 +159,104 @@ int main()
     // employee name
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, data["employee"]["name"].get<string>(), 36, false, "center");
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // employee position and department
     paragraph = api.Call("CreateParagraph");
     string employeeInfo = "Position: " + data["employee"]["position"].get<string>();
     employeeInfo += "\nDepartment: " + data["employee"]["department"].get<string>();
     addTextToParagraph(paragraph, employeeInfo, 24, false, "center");
     paragraph.Call("AddPageBreak");
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
+    content.Flush();
 
     // COMPETENCIES SECION
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Competencies", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // technical skills sub-header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Technical skills:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // technical skills table
     const json& technicalSkills = data["competencies"]["technical_skills"];
     CValue table = createTable(api, (int)technicalSkills.size() + 1, 2);
     fillTableHeaders(table, { "Skill", "Level" }, 22);
     fillTableBody(table, technicalSkills, { "name", "level" }, 22);
-    document.Call("Push", table);
+    content.Add(table);
     // soft skills sub-header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Soft skills:", 24);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // soft skills table
     const json& softSkills = data["competencies"]["soft_skills"];
     table = createTable(api, (int)softSkills.size() + 1, 2);
     fillTableHeaders(table, { "Skill", "Level" }, 22);
     fillTableBody(table, softSkills, { "name", "level" }, 22);
-    document.Call("Push", table);
+    content.Add(table);
+    content.Flush();
 
     // DEVELOPMENT AREAS section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Development areas", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // list
-    createNumbering(api, data["development_areas"], "numbered", 22);
+    createNumbering(api, document, content, data["development_areas"], "numbered", 22);
+    content.Flush();
 
     // GOALS section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Goals for next year", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // numbering
-    paragraph = createNumbering(api, data["goals_next_year"], "numbered", 22);
+    paragraph = createNumbering(api, document, content, data["goals_next_year"], "numbered", 22);
     // add a page break after the last paragraph
     paragraph.Call("AddPageBreak");
+    content.Flush();
 
     // RESOURCES section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Recommended resources", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // table
     const json& resources = data["resources"];
     table = createTable(api, (int)resources.size() + 1, 3);
     fillTableHeaders(table, { "Name", "Provider", "Duration" }, 22);
     fillTableBody(table, resources, { "name", "provider", "duration" }, 22);
-    document.Call("Push", table);
+    content.Add(table);
+    content.Flush();
 
     // FEEDBACK section
     // header
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Feedback", 32, true);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // manager's feedback
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Manager's feedback:", 24, false);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, string(280, '_'), 24, false);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     // employees's feedback
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, "Employee's feedback:", 24, false);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
     paragraph = api.Call("CreateParagraph");
     addTextToParagraph(paragraph, string(280, '_'), 24, false);
-    document.Call("Push", paragraph);
+    content.Add(paragraph);
+    content.Flush();
+    bench.Add("push_calls", (double)content.GetCallsCount(), "count");
+    bench.Phase("build");
 
     // save and close
     builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
+    bench.Phase("save");
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
+    cache.Store(resultPath, bench.GetTotalMs());
     return 0;
 }
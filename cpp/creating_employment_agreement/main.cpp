@@ -16,7 +16,10 @@
  *
  */
 
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -25,6 +28,9 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/batch.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
@@ -127,22 +133,15 @@ string stringJoin(const vector<string>& strArray) {
     return resultString;
 }
 
-// Main function
-int main() {
-    // parse JSON
-    string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/employment_agreement_data.json";
-    ifstream fs(jsonPath);
-    json data = json::parse(fs);
-
-    // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
-    builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF);
-
+// Builds the agreement in the new document of `builder` paragraph by paragraph
+void buildAgreement(CDocBuilder& builder, const json& data) {
     CContext context = builder.GetContext();
+    CContextScope scope = context.CreateScope();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
     CValue document = api.Call("GetDocument");
+    // paragraphs are pushed to the document by batches, one per section
+    NSUtils::CDocumentBatch<CValue> content(document);
 
     // DOCUMENT STYLE
     CValue paraPr = document.Call("GetDefaultParaPr");
@@ -162,7 +161,7 @@ int main() {
         "This Employment Agreement (\"Agreement\") is made and entered into on " + data["date"].get<string>() + " by and between:"
     );
     setSpacingAfter(headerDesc, 50);
-    document.Call("Push", headerDesc);
+    content.Add(headerDesc);
 
     // PARTICIPANTS OF THE DOCUMENT
     CValue participants = createParagraph(api, "", false, defaultFontSize, "left");
@@ -181,8 +180,9 @@ int main() {
         "Employee",
         employee["full_name"].get<string>() + ", residing at " + employee["address"].get<string>() + "."
     );
-    document.Call("Push", participants);
-    document.Call("Push", createParagraph(api, "The parties agree to the following terms and conditions:"));
+    content.Add(participants);
+    content.Add(createParagraph(api, "The parties agree to the following terms and conditions:"));
+    content.Flush();
 
     // AGREEMENT CONDITIONS
     // Create numbering
@@ -192,9 +192,8 @@ int main() {
     numberingLvl.Call("SetSuff", "space");
 
     // Position and duties
-    document.Call("Push", createNumberedSection(api, "POSITION AND DUTIES", numberingLvl));
-    document.Call(
-        "Push",
+    content.Add(createNumberedSection(api, "POSITION AND DUTIES", numberingLvl));
+    content.Add(
         createConditionsDescParagraph(
             api,
             "The Employee is hired as " + data["position_and_duties"]["job_title"].get<string>() +
@@ -203,10 +202,9 @@ int main() {
     );
 
     // Compensation
-    document.Call("Push", createNumberedSection(api, "COMPENSATION", numberingLvl));
+    content.Add(createNumberedSection(api, "COMPENSATION", numberingLvl));
     const json& compensation = data["compensation"];
-    document.Call(
-        "Push",
+    content.Add(
         createConditionsDescParagraph(
             api,
             "The Employee will receive a salary of " + to_string(compensation["salary"].get<int>()) + " " +
@@ -216,10 +214,9 @@ int main() {
     );
 
     // Probationary period
-    document.Call("Push", createNumberedSection(api, "PROBATIONARY PERIOD", numberingLvl));
+    content.Add(createNumberedSection(api, "PROBATIONARY PERIOD", numberingLvl));
     const json& probPeriod = data["probationary_period"];
-    document.Call(
-        "Push",
+    content.Add(
         createConditionsDescParagraph(
             api,
             "The Employee will serve a probationary period of " + probPeriod["duration"].get<string>() +
@@ -229,41 +226,37 @@ int main() {
     );
 
     // Work conditions
-    document.Call("Push", createNumberedSection(api, "WORK CONDITIONS", numberingLvl));
+    content.Add(createNumberedSection(api, "WORK CONDITIONS", numberingLvl));
     CValue conditionsText = createConditionsDescParagraph(
         api,
         "The following terms apply to the Employee's working conditions:"
     );
     setSpacingAfter(conditionsText, 50);
-    document.Call("Push", conditionsText);
+    content.Add(conditionsText);
 
     // Create bullet numbering
     CValue bulletNumbering = document.Call("CreateNumbering", "bullet");
     CValue bulletNumLvl = bulletNumbering.Call("GetLevel", 0);
 
     const json& workConditions = data["work_conditions"];
-    document.Call(
-        "Push",
+    content.Add(
         createWorkCondition(api, "Working Hours", workConditions["working_hours"].get<string>(), bulletNumLvl, true)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createWorkCondition(api, "Work Schedule", workConditions["work_schedule"].get<string>(), bulletNumLvl, true)
     );
     const vector<string>& benefitsArray = workConditions["benefits"];
     string benefits = stringJoin(benefitsArray);
-    document.Call("Push", createWorkCondition(api, "Benefits", benefits, bulletNumLvl, true));
+    content.Add(createWorkCondition(api, "Benefits", benefits, bulletNumLvl, true));
     const vector<string>& otherTermsArray = workConditions["other_terms"];
     string otherTerms = stringJoin(otherTermsArray);
-    document.Call(
-        "Push",
+    content.Add(
         createWorkCondition(api, "Other terms", otherTerms, bulletNumLvl, false)
     );
 
     // TERMINATION
-    document.Call("Push", createNumberedSection(api, "TERMINATION", numberingLvl));
-    document.Call(
-        "Push",
+    content.Add(createNumberedSection(api, "TERMINATION", numberingLvl));
+    content.Add(
         createConditionsDescParagraph(
             api,
             "Either party may terminate this Agreement by providing " + data["termination"]["notice_period"].get<string>() +
@@ -272,9 +265,8 @@ int main() {
     );
 
     // GOVERNING LAW
-    document.Call("Push", createNumberedSection(api, "GOVERNING LAW", numberingLvl));
-    document.Call(
-        "Push",
+    content.Add(createNumberedSection(api, "GOVERNING LAW", numberingLvl));
+    content.Add(
         createConditionsDescParagraph(
             api,
             "This Agreement is governed by the laws of " + data["governing_law"]["jurisdiction"].get<string>() +
@@ -283,9 +275,8 @@ int main() {
     );
 
     // ENTIRE AGREEMENT
-    document.Call("Push", createNumberedSection(api, "ENTIRE AGREEMENT", numberingLvl));
-    document.Call(
-        "Push",
+    content.Add(createNumberedSection(api, "ENTIRE AGREEMENT", numberingLvl));
+    content.Add(
         createConditionsDescParagraph(
             api,
             "This document constitutes the entire Agreement between the parties and supersedes all prior agreements. Any amendments must be made in writing and signed by both parties."
@@ -302,11 +293,157 @@ int main() {
     titleParagraph.Call("Push", createRun(api, "SIGNATURES", true, 24));
     fillSigner(api, table.Call("GetCell", 1, 0), "Employer");
     fillSigner(api, table.Call("GetCell", 1, 1), "Employee");
-    document.Call("Push", table);
+    content.Add(table);
+    content.Flush();
+}
 
-    // Save and close
-    builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF, resultPath);
+// Values of the text forms of the agreement template by their keys.
+// Only these fields differ between agreements, the rest of the text is authored in the template.
+map<wstring, wstring> getAgreementFormData(const json& data) {
+    map<string, string> fields;
+    fields["date"] = data["date"].get<string>();
+    fields["employer_name"] = data["employer"]["name"].get<string>();
+    fields["employer_address"] = data["employer"]["address"].get<string>();
+    fields["employee_full_name"] = data["employee"]["full_name"].get<string>();
+    fields["employee_address"] = data["employee"]["address"].get<string>();
+    fields["job_title"] = data["position_and_duties"]["job_title"].get<string>();
+    const json& compensation = data["compensation"];
+    fields["salary"] = to_string(compensation["salary"].get<int>());
+    fields["currency"] = compensation["currency"].get<string>();
+    fields["frequency"] = compensation["frequency"].get<string>();
+    fields["salary_type"] = compensation["type"].get<string>();
+    fields["probation_duration"] = data["probationary_period"]["duration"].get<string>();
+    fields["probation_terminate"] = data["probationary_period"]["terminate"].get<string>();
+    const json& workConditions = data["work_conditions"];
+    fields["working_hours"] = workConditions["working_hours"].get<string>();
+    fields["work_schedule"] = workConditions["work_schedule"].get<string>();
+    fields["benefits"] = stringJoin(workConditions["benefits"].get<vector<string>>());
+    fields["other_terms"] = stringJoin(workConditions["other_terms"].get<vector<string>>());
+    fields["notice_period"] = data["termination"]["notice_period"].get<string>();
+    fields["jurisdiction"] = data["governing_law"]["jurisdiction"].get<string>();
+
+    map<wstring, wstring> formData;
+    for (const auto& field : fields) {
+        wstring key = NSUtils::GetStringFromUtf8((const unsigned char*)field.first.c_str(), field.first.length());
+        formData[key] = NSUtils::GetStringFromUtf8((const unsigned char*)field.second.c_str(), field.second.length());
+    }
+    return formData;
+}
+
+// Fills text forms of the agreement template opened in `builder` by their keys (as filling_form does)
+void fillAgreementTemplate(CDocBuilder& builder, const map<wstring, wstring>& formData) {
+    CContext context = builder.GetContext();
+    CContextScope scope = context.CreateScope();
+    CValue global = context.GetGlobal();
+    CValue api = global["Api"];
+    CValue document = api.Call("GetDocument");
+    CValue aForms = document.Call("GetAllForms");
+
+    for (int formNum = 0; formNum < (int)aForms.GetLength(); formNum++) {
+        CValue form = aForms[formNum];
+        wstring type = form.Call("GetFormType").ToString().c_str();
+        map<wstring, wstring>::const_iterator value = formData.find(form.Call("GetFormKey").ToString().c_str());
+        if (type == L"textForm" && value != formData.end()) {
+            form.Call("SetText", value->second.c_str());
+        }
+    }
+}
+
+// Generates one agreement and saves it to `path`: fills the template if `templatePath` is set, or builds it from scratch
+bool generateAgreement(CDocBuilder& builder, const json& data, const wstring& templatePath, const wchar_t* path) {
+    if (templatePath.empty()) {
+        builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF);
+        buildAgreement(builder, data);
+    } else {
+        if (builder.OpenFile(templatePath.c_str(), L"") != 0) {
+            return false;
+        }
+        fillAgreementTemplate(builder, getAgreementFormData(data));
+    }
+    int error = builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF, path);
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    return error == 0;
+}
+
+// Generates `count` agreements one after another and collects latency of every one of them
+void runAgreements(CDocBuilder& builder, const json& data, const wstring& templatePath, int count, NSUtils::CLatencyStats& latency) {
+    for (int i = 0; i < count; i++) {
+        NSUtils::CStopwatch stopwatch;
+        if (generateAgreement(builder, data, templatePath, resultPath)) {
+            latency.Add(stopwatch.GetElapsedMs());
+        }
+    }
+}
+
+// Main function
+// Usage: creating_employment_agreement [--template] [--count N] [--compare] [data.json]
+//   --template  - fill text forms of resources/docs/employment_agreement.docx instead of building the whole agreement
+//   --count N   - generate N agreements one after another and print latency percentiles
+//   --compare   - generate N agreements (100 by default) from scratch and from the template and compare their latency
+int main(int argc, char* argv[]) {
+    NSUtils::CBenchTimer bench("creating_employment_agreement");
+    string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/employment_agreement_data.json";
+    wstring agreementTemplate = NSUtils::GetResourcesDirectory() + L"/docs/employment_agreement.docx";
+    bool useTemplate = false;
+    bool compare = false;
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--template") {
+            useTemplate = true;
+        } else if (arg == "--count" && i + 1 < argc) {
+            count = max(atoi(argv[++i]), 1);
+        } else if (arg == "--compare") {
+            compare = true;
+        } else {
+            jsonPath = arg;
+        }
+    }
+
+    // parse JSON
+    ifstream fs(jsonPath);
+    json data = json::parse(fs);
+    bench.Phase("parse");
+
+    // Init DocBuilder
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    bench.Phase("init");
+
+    if (compare) {
+        count = count > 0 ? count : 100;
+        NSUtils::CLatencyStats constructiveLatency;
+        NSUtils::CLatencyStats templateLatency;
+        runAgreements(builder, data, L"", count, constructiveLatency);
+        double constructiveMs = bench.Phase("constructive");
+        runAgreements(builder, data, agreementTemplate, count, templateLatency);
+        double templateMs = bench.Phase("template");
+
+        constructiveLatency.Report(bench, "latency constructive");
+        templateLatency.Report(bench, "latency template");
+        printf("constructive: %.0f ms, %.2f agreements/s\n", constructiveMs, count * 1000.0 / constructiveMs);
+        printf("template:     %.0f ms, %.2f agreements/s\n", templateMs, count * 1000.0 / templateMs);
+        engine.Dispose();
+        return templateLatency.GetCount() == (size_t)count ? 0 : 1;
+    }
+
+    wstring templatePath = useTemplate ? agreementTemplate : L"";
+    if (count > 0) {
+        NSUtils::CLatencyStats latency;
+        runAgreements(builder, data, templatePath, count, latency);
+        bench.Phase(useTemplate ? "template" : "constructive");
+        latency.Report(bench, useTemplate ? "latency template" : "latency constructive");
+        engine.Dispose();
+        return 0;
+    }
+
+    // Build (or fill), save and close
+    bool saved = generateAgreement(builder, data, templatePath, resultPath);
+    bench.Phase(useTemplate ? "template" : "build");
+    engine.Dispose();
+    if (!saved) {
+        fprintf(stderr, "Failed to generate the agreement\n");
+        return 1;
+    }
     return 0;
 }
@@ -24,27 +24,65 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/methods.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
 using namespace NSDoctRenderer;
 using json = nlohmann::json;
+namespace NSMethods = NSUtils::NSMethods;
 
 const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.xlsx";
 
-// Main function
-int main()
+// Number of API calls made to color status cells, used to compare direct fill with conditional formatting
+int stylingCalls = 0;
+
+// Adds conditional formatting rules coloring status cells of `rowsCount` rows by their text.
+// The number of rules doesn't depend on the number of rows.
+void addStatusFormatting(CValue worksheet, int rowsCount, CValue colorInStock, CValue colorReserved, CValue colorOther)
 {
-    // parse JSON
+    string address = "C2:C" + to_string(rowsCount + 1);
+    CValue conditions = worksheet.Call("GetRange", address.c_str()).Call("GetFormatConditions");
+    stylingCalls += 2;
+    conditions.Call("Add", "xlCellValue", "xlEqual", "=\"In Stock\"").Call(NSMethods::SetFillColor, colorInStock);
+    stylingCalls += 2;
+    conditions.Call("Add", "xlCellValue", "xlEqual", "=\"Reserved\"").Call(NSMethods::SetFillColor, colorReserved);
+    stylingCalls += 2;
+    // formula is relative to the first cell of the range
+    conditions.Call("Add", "xlExpression", "", "=AND(C2<>\"In Stock\",C2<>\"Reserved\")").Call(NSMethods::SetFillColor, colorOther);
+    stylingCalls += 2;
+}
+
+// Usage: creating_inventory_report [--direct-fill] [data.json]
+//   --direct-fill - color every status cell with its own SetFillColor call instead of
+//                   adding conditional formatting rules to the status column
+int main(int argc, char* argv[])
+{
+    NSUtils::CBenchTimer bench("creating_inventory_report");
     string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/ims_response.json";
+    bool directFill = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--direct-fill")
+            directFill = true;
+        else
+            jsonPath = arg;
+    }
+
+    // parse JSON
     ifstream fs(jsonPath);
     json data = json::parse(fs);
+    bench.Phase("parse");
 
     // init docbuilder and create new xlsx file
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
+    bench.Phase("init");
 
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
@@ -59,33 +97,47 @@ int main()
     CValue startCell = worksheet.Call("GetRangeByNumber", 0, 0);
     CValue endCell = worksheet.Call("GetRangeByNumber", 0, 2);
     worksheet.Call("GetRange", startCell, endCell).Call("SetBold", true);
+    // status colors
+    CValue colorInStock = api.Call(NSMethods::CreateColorFromRGB, 0, 194, 87);
+    CValue colorReserved = api.Call(NSMethods::CreateColorFromRGB, 255, 255, 0);
+    CValue colorOther = api.Call(NSMethods::CreateColorFromRGB, 255, 79, 79);
     // fill table data
     const json& inventory = data["inventory"];
+    stylingCalls = 0;
     for (int i = 0; i < (int)inventory.size(); i++)
     {
         const json& entry = inventory[i];
-        CValue cell = worksheet.Call("GetRangeByNumber", i + 1, 0);
-        cell.Call("SetValue", entry["item"].get<string>().c_str());
-        cell = worksheet.Call("GetRangeByNumber", i + 1, 1);
-        cell.Call("SetValue", to_string(entry["quantity"].get<int>()).c_str());
-        cell = worksheet.Call("GetRangeByNumber", i + 1, 2);
+        CValue cell = worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 0);
+        cell.Call(NSMethods::SetValue, entry["item"].get<string>().c_str());
+        cell = worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 1);
+        cell.Call(NSMethods::SetValue, to_string(entry["quantity"].get<int>()).c_str());
+        cell = worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 2);
         string status = entry["status"].get<string>();
-        cell.Call("SetValue", status.c_str());
+        cell.Call(NSMethods::SetValue, status.c_str());
         // fill cell with color corresponding to status
+        if (!directFill)
+            continue;
         if (status == "In Stock")
-            cell.Call("SetFillColor", api.Call("CreateColorFromRGB", 0, 194, 87));
+            cell.Call(NSMethods::SetFillColor, colorInStock);
         else if (status == "Reserved")
-            cell.Call("SetFillColor", api.Call("CreateColorFromRGB", 255, 255, 0));
+            cell.Call(NSMethods::SetFillColor, colorReserved);
         else
-            cell.Call("SetFillColor", api.Call("CreateColorFromRGB", 255, 79, 79));
+            cell.Call(NSMethods::SetFillColor, colorOther);
+        stylingCalls++;
     }
+    if (!directFill && !inventory.empty())
+        addStatusFormatting(worksheet, (int)inventory.size(), colorInStock, colorReserved, colorOther);
+    bench.Add("styling_calls", (double)stylingCalls, "count");
     // tweak cells width
     worksheet.Call("GetRange", "A1").Call("SetColumnWidth", 40);
     worksheet.Call("GetRange", "C1").Call("SetColumnWidth", 15);
+    bench.Phase("build");
 
     // save and close
     builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath);
+    bench.Phase("save");
+    bench.AddFileSize("result_size", U_TO_UTF8(wstring(resultPath)));
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
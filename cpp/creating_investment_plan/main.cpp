@@ -25,6 +25,7 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/engine.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
@@ -56,8 +57,8 @@ int main()
     json data = json::parse(fs);
 
     // init docbuilder and create new xlsx file
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
 
     CContext context = builder.GetContext();
@@ -109,6 +110,6 @@ int main()
     // save and close
     builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath);
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -16,8 +16,11 @@
  *
  */
 
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <string>
+#include <vector>
 #include <algorithm>
 
 #include "common.h"
@@ -25,11 +28,18 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/batch.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/export.h"
+#include "resources/utils/json_stream.h"
+#include "resources/utils/methods.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
 using namespace NSDoctRenderer;
 using json = nlohmann::json;
+namespace NSMethods = NSUtils::NSMethods;
 
 const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.pdf";
@@ -81,83 +91,157 @@ CValue createRequisitesParagraph(CValue api, string title, string details, CValu
     return paragraph;
 }
 
-void setupTableStyle(CValue document, CValue table) {
-    // table size
-    table.Call("SetWidth", "percent", 100);
-    table.Call("Select");
-    CValue tableRange = document.Call("GetRangeBySelect");
-    CValue tableParagraphs = tableRange.Call("GetAllParagraphs");
-    for (int i = 0; i < (int)tableParagraphs.GetLength(); i++) {
-        CValue paraPr = tableParagraphs.Get(i).Call("GetParaPr");
-        paraPr.Call("SetSpacingBefore", 40);
-        paraPr.Call("SetSpacingAfter", 40);
-    }
+CValue createTableStyle(CValue document) {
+    // table style is created once per document: its paragraph properties
+    // apply to every cell paragraph, so no per-cell calls are needed
+    CValue tableStyle = document.Call("CreateStyle", "Items Table", "table");
+    CValue paraPr = tableStyle.Call("GetParaPr");
+    paraPr.Call("SetSpacingBefore", 40);
+    paraPr.Call("SetSpacingAfter", 40);
 
     // table borders
-    table.Call("SetTableBorderTop", "single", 4, 0, 0, 0, 0);
-    table.Call("SetTableBorderBottom", "single", 4, 0, 0, 0, 0);
-    table.Call("SetTableBorderLeft", "single", 4, 0, 0, 0, 0);
-    table.Call("SetTableBorderRight", "single", 4, 0, 0, 0, 0);
-    table.Call("SetTableBorderInsideV", "single", 4, 0, 0, 0, 0);
-    table.Call("SetTableBorderInsideH", "single", 4, 0, 0, 0, 0);
+    CValue tablePr = tableStyle.Call("GetTablePr");
+    tablePr.Call("SetTableBorderTop", "single", 4, 0, 0, 0, 0);
+    tablePr.Call("SetTableBorderBottom", "single", 4, 0, 0, 0, 0);
+    tablePr.Call("SetTableBorderLeft", "single", 4, 0, 0, 0, 0);
+    tablePr.Call("SetTableBorderRight", "single", 4, 0, 0, 0, 0);
+    tablePr.Call("SetTableBorderInsideV", "single", 4, 0, 0, 0, 0);
+    tablePr.Call("SetTableBorderInsideH", "single", 4, 0, 0, 0, 0);
+    return tableStyle;
+}
+
+void setupTableStyle(CValue table, CValue tableStyle) {
+    // table size
+    table.Call("SetWidth", "percent", 100);
+    table.Call("SetStyle", tableStyle);
 }
 
 CValue getCellContent(CValue cell) {
-    return cell.Call("GetContent").Call("GetElement", 0);
+    return cell.Call(NSMethods::GetContent).Call(NSMethods::GetElement, 0);
 }
 
-void fillTableContent(CValue table, json& items) {
-    string tableHeaders[] = {"Description", "Quantity", "Unit Price", "Total"};
-    string tableFields[] = {"description", "quantity", "unit_price", "total"};
+const string tableHeaders[] = {"Description", "Quantity", "Unit Price", "Total"};
+const string tableFields[] = {"description", "quantity", "unit_price", "total"};
+const int tableFieldsSize = sizeof(tableFields) / sizeof(tableFields[0]);
 
-    // fill table header
-    const int tableHeadersSize = sizeof(tableHeaders) / sizeof(tableHeaders[0]);
+void fillTableHeader(CValue table) {
     CValue headerRow = table.Call("GetRow", 0);
-    for (int i = 0; i < tableHeadersSize; i++) {
+    // repeat header row at the top of each page
+    headerRow.Call("SetHeading", true);
+    for (int i = 0; i < tableFieldsSize; i++) {
         CValue headerCell = getCellContent(headerRow.Call("GetCell", i));
         headerCell.Call("AddText", tableHeaders[i].c_str());
         headerCell.Call("SetBold", true);
     }
+}
 
-    // fill items
+json createEmptyItem() {
     json emptyItem;
     for (const auto& field : tableFields) {
         emptyItem[field] = "...";
     }
-    items.push_back(emptyItem);
+    return emptyItem;
+}
 
-    const int tableFieldsSize = sizeof(tableFields) / sizeof(tableFields[0]);
-    for (int i = 0; i < (int)items.size(); i++) {
-        CValue row = table.Call("GetRow", i + 1);
-        for (int j = 0; j < tableFieldsSize; j++) {
-            CValue cell = getCellContent(row.Call("GetCell", j));
-            json value = items[i][tableFields[j]];
-            string strValue;
-            if (value.is_string()) {
-                strValue = value.get<string>();
-            } else {
-                strValue = to_string(value.get<int>());
-            }
-            cell.Call("AddText", strValue.c_str());
+void fillTableRow(CValue row, const json& item) {
+    for (int j = 0; j < tableFieldsSize; j++) {
+        CValue cell = getCellContent(row.Call(NSMethods::GetCell, j));
+        const json& value = item[tableFields[j]];
+        string strValue;
+        if (value.is_string()) {
+            strValue = value.get<string>();
+        } else {
+            strValue = to_string(value.get<int>());
         }
+        cell.Call(NSMethods::AddText, strValue.c_str());
     }
 }
 
-int main() {
-    // parse JSON
+void fillTableContent(CValue table, json& items) {
+    fillTableHeader(table);
+
+    // fill items
+    items.push_back(createEmptyItem());
+    for (int i = 0; i < (int)items.size(); i++) {
+        fillTableRow(table.Call(NSMethods::GetRow, i + 1), items[i]);
+    }
+}
+
+// Appends rows for `items` after the last of `rowsCount` table rows
+void appendTableRows(CContext context, CValue table, int& rowsCount, const vector<json>& items) {
+    if (items.empty()) {
+        return;
+    }
+    // JS values created for the batch are released when the scope is closed
+    CContextScope scope = context.CreateScope();
+    CValue lastCell = table.Call(NSMethods::GetCell, rowsCount - 1, 0);
+    table.Call(NSMethods::AddRows, lastCell, (int)items.size(), false);
+    for (int i = 0; i < (int)items.size(); i++) {
+        fillTableRow(table.Call(NSMethods::GetRow, rowsCount + i), items[i]);
+    }
+    rowsCount += (int)items.size();
+}
+
+// Reads items from JSON stream and adds them to the table by batches of `chunkSize` rows,
+// so only one batch is kept in memory. Returns the number of added rows.
+int fillTableContentChunked(CContext context, CValue table, istream& input, int chunkSize) {
+    fillTableHeader(table);
+
+    int rowsCount = 1;
+    vector<json> batch;
+    batch.reserve(chunkSize);
+    NSUtils::ParseJsonStreamingArray(input, "items", [&](json& item) {
+        batch.push_back(std::move(item));
+        if ((int)batch.size() == chunkSize) {
+            appendTableRows(context, table, rowsCount, batch);
+            batch.clear();
+        }
+    });
+    batch.push_back(createEmptyItem());
+    appendTableRows(context, table, rowsCount, batch);
+    return rowsCount - 1;
+}
+
+// Usage: creating_invoice [--chunk-size N] [--export-all] [--no-batch] [data.json]
+// With --chunk-size items are streamed from the data file and added to the table by batches of N rows
+// With --export-all invoice is also saved as DOCX and PNG thumbnail
+// With --no-batch every paragraph is pushed to the document with its own call instead of one batch per section
+int main(int argc, char* argv[]) {
+    NSUtils::HandleExportHelper(argc, argv, workDir);
+    NSUtils::CBenchTimer bench("creating_invoice");
+
     string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/invoice_response.json";
+    int chunkSize = 0;
+    bool exportAll = false;
+    bool batchPush = true;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--chunk-size" && i + 1 < argc) {
+            chunkSize = max(atoi(argv[++i]), 1);
+        } else if (string(argv[i]) == "--export-all") {
+            exportAll = true;
+        } else if (string(argv[i]) == "--no-batch") {
+            batchPush = false;
+        } else {
+            jsonPath = argv[i];
+        }
+    }
+
+    // parse JSON (in chunked mode items are read later, while the table is being filled)
     ifstream fs(jsonPath);
-    json data = json::parse(fs);
+    json data = chunkSize > 0 ? NSUtils::ParseJsonStreamingArray(fs, "items") : json::parse(fs);
+    bench.Phase("parse");
 
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF);
 
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
     CValue document = api.Call("GetDocument");
+    NSUtils::CDocumentBatch<CValue> content(document, batchPush);
+    bench.Phase("init");
 
     // DOCUMENT STYLE
     CValue textPr = document.Call("GetDefaultTextPr");
@@ -169,12 +253,10 @@ int main() {
     fillHeader(header, "INVOICE");
 
     // document requisites
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Invoice No.", data["invoice"]["number"].get<string>(), CValue::CreateUndefined())
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Date", data["invoice"]["date"].get<string>(), CValue::CreateUndefined(), false)
     );
 
@@ -184,83 +266,89 @@ int main() {
 
     // SELLER INFORMATION
     CValue sellerHeader = createDetailsHeader(api, "SELLER INFORMATION");
-    document.Call("Push", sellerHeader);
+    content.Add(sellerHeader);
 
     // seller details
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Company Name", data["seller"]["company_name"].get<string>(), numLvl1)
     );
-    document.Call(
-        "Push", createRequisitesParagraph(api, "Address", data["seller"]["address"].get<string>(), numLvl1)
+    content.Add(
+        createRequisitesParagraph(api, "Address", data["seller"]["address"].get<string>(), numLvl1)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Tax ID (TIN)", data["seller"]["tin"].get<string>(), numLvl1)
     );
-    document.Call("Push", createRequisitesParagraph(api, "Bank Details", "", numLvl1));
+    content.Add(createRequisitesParagraph(api, "Bank Details", "", numLvl1));
 
     // bank details
     CValue numLvl2 = bulletNumbering.Call("GetLevel", 1);
     numLvl2.Call("SetCustomType", "none", "", "left");
     numLvl2.Call("SetSuff", "space");
 
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Bank Name", data["seller"]["bank_details"]["bank_name"].get<string>(), numLvl2, true, false)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Account Number", data["seller"]["bank_details"]["account_number"].get<string>(), numLvl2, true, false)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "SWIFT Code", data["seller"]["bank_details"]["swift_code"].get<string>(), numLvl2, false, false)
     );
 
     // BUYER INFORMATION
     CValue buyerHeader = createDetailsHeader(api, "BUYER INFORMATION");
-    document.Call("Push", buyerHeader);
+    content.Add(buyerHeader);
 
     // buyer details
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Company Name", data["buyer"]["company_name"].get<string>(), numLvl1)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Address", data["buyer"]["address"].get<string>(), numLvl1)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Tax ID (TIN)", data["buyer"]["tin"].get<string>(), numLvl1, false)
     );
 
     // TABLE OF ITEMS
     CValue tableHeader = api.Call("CreateParagraph");
     fillHeader(tableHeader, "TABLE OF ITEMS");
-    document.Call("Push", tableHeader);
+    content.Add(tableHeader);
 
     // table content
-    json items = data["items"];
-    CValue itemsTable = api.Call("CreateTable", 4, (int)items.size() + 2);
-    document.Call("Push", itemsTable);
-    setupTableStyle(document, itemsTable);
-    fillTableContent(itemsTable, items);
+    if (chunkSize > 0) {
+        NSUtils::CStopwatch tableTimer;
+        CValue itemsTable = api.Call("CreateTable", tableFieldsSize, 1);
+        content.Add(itemsTable);
+        content.Flush();
+        setupTableStyle(itemsTable, createTableStyle(document));
+        ifstream itemsStream(jsonPath);
+        int rowsCount = fillTableContentChunked(context, itemsTable, itemsStream, chunkSize);
+
+        double tableMs = tableTimer.GetElapsedMs();
+        double rowsPerSec = tableMs > 0 ? rowsCount * 1000.0 / tableMs : 0;
+        bench.Add("table_rows", rowsCount, "count");
+        bench.Add("table_rows_per_sec", rowsPerSec, "rows/s");
+        printf("Items table: %d rows in %.0f ms (%.0f rows/s, %d rows per chunk)\n", rowsCount, tableMs, rowsPerSec, chunkSize);
+    } else {
+        json items = data["items"];
+        CValue itemsTable = api.Call("CreateTable", tableFieldsSize, (int)items.size() + 2);
+        content.Add(itemsTable);
+        content.Flush();
+        setupTableStyle(itemsTable, createTableStyle(document));
+        fillTableContent(itemsTable, items);
+    }
 
     // TOTALS
     CValue totals = createDetailsHeader(api, "TOTALS");
-    document.Call("Push", totals);
-    document.Call(
-        "Push",
+    content.Add(totals);
+    content.Add(
         createRequisitesParagraph(api, "Subtotal", "$" + to_string(data["totals"]["subtotal"].get<int>()), numLvl1)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Tax (20% VAT)", "$" + to_string(data["totals"]["tax"].get<int>()), numLvl1)
     );
-    document.Call(
-        "Push",
+    content.Add(
         createRequisitesParagraph(api, "Total Amount Due", "$" + to_string(data["totals"]["total_due"].get<int>()), numLvl1, false)
     );
 
@@ -268,7 +356,7 @@ int main() {
     CValue signHeader = api.Call("CreateParagraph");
     signHeader.Call("AddText", "Signature:");
     signHeader.Call("SetBold", true);
-    document.Call("Push", signHeader);
+    content.Add(signHeader);
 
     CValue signDetails = api.Call("CreateParagraph");
     signDetails.Call(
@@ -277,11 +365,27 @@ int main() {
     );
     signDetails.Call("AddLineBreak");
     signDetails.Call("AddText", data["seller"]["company_name"].get<string>().c_str());
-    document.Call("Push", signDetails);
+    content.Add(signDetails);
+    content.Flush();
+    bench.Add("push_calls", (double)content.GetCallsCount(), "count");
+    bench.Phase("build");
 
     // Save and close
-    builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF, resultPath);
+    bool saved = true;
+    if (exportAll) {
+        // DOCX is saved first and then converted to PDF and thumbnail concurrently
+        vector<NSUtils::CExportFormat> formats = {
+            { OFFICESTUDIO_FILE_DOCUMENT_DOCX, L"result.docx", L"" },
+            { OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF, resultPath, L"" },
+            { OFFICESTUDIO_FILE_IMAGE, L"result.png", NSUtils::GetThumbnailParams() }
+        };
+        saved = NSUtils::ReportExportResults(NSUtils::ExportDocument(builder, formats), bench);
+    } else {
+        builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_OFORM_PDF, resultPath);
+    }
+    bench.Phase("save");
     builder.CloseFile();
-    CDocBuilder::Dispose();
-    return 0;
+    engine.Dispose();
+    // failed conversion must fail the run, so it isn't measured as a successful one
+    return saved ? 0 : 1;
 }
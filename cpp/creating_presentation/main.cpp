@@ -22,6 +22,10 @@
 #include "docbuilder.h"
 
 #include "out/cpp/builder_path.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/image_cache.h"
+#include "resources/utils/image_resize.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -55,17 +59,40 @@ void addTextToSlideShape(CValue api, CValue content, string text, int fontSize,
 }
 
 // Main function
-int main()
+// With --no-downscale images are used in their original size
+int main(int argc, char* argv[])
 {
+    bool downscale = !(argc > 1 && string(argv[1]) == "--no-downscale");
+    NSUtils::CBenchTimer bench("creating_presentation");
+    const int slideWidth = 9144000;
+    const int slideHeight = 6858000;
     map<string, string>slideImages;
     slideImages["gun"] = "https://static.onlyoffice.com/assets/docs/samples/img/presentation_gun.png";
     slideImages["axe"] = "https://static.onlyoffice.com/assets/docs/samples/img/presentation_axe.png";
     slideImages["knight"] = "https://static.onlyoffice.com/assets/docs/samples/img/presentation_knight.png";
     slideImages["sky"] = "https://static.onlyoffice.com/assets/docs/samples/img/presentation_sky.png";
 
+    // Download all images at once and use local copies
+    NSUtils::CImagePrefetcher images;
+    for (const auto& image : slideImages)
+        images.Add(image.second);
+    images.Fetch(bench);
+    bench.Skip();
+
+    // Backgrounds are stretched to the slide, so the images are resized to its size
+    NSUtils::CImageDownscaler downscaler;
+    for (auto& image : slideImages)
+    {
+        image.second = images.Get(image.second);
+        if (downscale)
+            image.second = downscaler.Downscale(image.second, slideWidth, slideHeight, false);
+    }
+    downscaler.Report(bench);
+    bench.Skip();
+
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX);
 
     CContext context = builder.GetContext();
@@ -74,7 +101,7 @@ int main()
 
     // Create presentation
     CValue presentation = api.Call("GetPresentation");
-    presentation.Call("SetSizes", 9144000, 6858000);
+    presentation.Call("SetSizes", slideWidth, slideHeight);
 
     CValue slide = createImageSlide(api, presentation, slideImages["gun"]);
     presentation.Call("GetSlideByIndex", 0).Call("Delete");
@@ -134,9 +161,13 @@ int main()
     addTextToSlideShape(api, content, "stands for Peace", 132, false, "center");
     slide.Call("AddObject", shape);
 
+    bench.Phase("build");
+
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX, resultPath);
+    bench.Phase("save");
+    bench.AddFileSize("result_size", U_TO_UTF8(wstring(resultPath)));
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -16,6 +16,8 @@
  *
  */
 
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -25,6 +27,12 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/governor.h"
+#include "resources/utils/matrix.h"
+#include "resources/utils/memory_save.h"
+#include "resources/utils/pipeline.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
@@ -34,6 +42,9 @@ using json = nlohmann::json;
 const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.pptx";
 
+// Number of API calls made by the helper functions below, used to compare the ways of building competitor slides
+size_t apiCalls = 0;
+
 // Helper functions
 void addTextToParagraph(CValue api, CValue paragraph, const string& text, int fontSize, CValue fill, bool isBold = false, string jc = "left", string fontFamily = "Arial")
 {
@@ -45,6 +56,7 @@ void addTextToParagraph(CValue api, CValue paragraph, const string& text, int fo
     run.Call("SetFontFamily", fontFamily.c_str());
     paragraph.Call("AddElement", run);
     paragraph.Call("SetJc", jc.c_str());
+    apiCalls += 8;
 }
 
 CValue addNewSlide(CValue api, CValue fill)
@@ -54,6 +66,7 @@ CValue addNewSlide(CValue api, CValue fill)
     presentation.Call("AddSlide", slide);
     slide.Call("SetBackground", fill);
     slide.Call("RemoveAllObjects");
+    apiCalls += 5;
     return slide;
 }
 
@@ -65,6 +78,7 @@ CValue addParagraphToSlide(CValue api, CValue slide, double width, double height
     shape.Call("SetPosition", pos_x * em_in_inch, pos_y * em_in_inch);
     CValue paragraph = shape.Call("GetDocContent").Call("GetElement", 0);
     slide.Call("AddObject", shape);
+    apiCalls += 5;
     return paragraph;
 }
 
@@ -102,17 +116,102 @@ CValue createStringArray(const vector<string>& values)
     return arrResult;
 }
 
-// Main function
-int main()
+// Texts with competitor's data in the competitor slide: name, recent funding, bullets and products
+vector<string> getCompetitorTexts(const json& competitor)
 {
-    string resourcesDir = U_TO_UTF8(NSUtils::GetResourcesDirectory());
+    string productsText;
+    for (const auto& product : competitor["products"])
+    {
+        productsText += product.get<string>() + "\n";
+    }
+    return { competitor["name"].get<string>(), competitor["recent_funding"].get<string>(),
+             makeBulletString('>', (int)competitor["products"].size()), productsText };
+}
+
+// indexes of the shapes holding getCompetitorTexts() in the competitor slide
+const int competitorTextShapes[] = { 1, 3, 5, 6 };
+
+// Creates the slide with brief info about the competitor from shapes
+CValue addCompetitorSlide(CValue api, const json& competitor, CValue backgroundFill, CValue textFill, CValue textSpecialFill)
+{
+    vector<string> texts = getCompetitorTexts(competitor);
+    CValue slide = addNewSlide(api, backgroundFill);
+    // title
+    CValue paragraph = addParagraphToSlide(api, slide, 11.8, 0.8, 0.8, 0.4);
+    addTextToParagraph(api, paragraph, "Competitors Overview", 72, textFill, false, "center");
+    // header
+    paragraph = addParagraphToSlide(api, slide, 11.8, 0.8, 0.8, 1.2);
+    addTextToParagraph(api, paragraph, texts[0], 64, textFill, false, "center");
+    // recent funding
+    paragraph = addParagraphToSlide(api, slide, 3.13, 0.8, 1.07, 2.65);
+    addTextToParagraph(api, paragraph, "Recent funding:", 48, textFill);
+    paragraph = addParagraphToSlide(api, slide, 8.9, 0.8, 4.19, 2.52);
+    addTextToParagraph(api, paragraph, texts[1], 96, textSpecialFill, false, "left", "Arial Black");
+    // main products
+    paragraph = addParagraphToSlide(api, slide, 3.13, 0.8, 1.07, 3.72);
+    addTextToParagraph(api, paragraph, "Main products:", 48, textFill);
+    paragraph = addParagraphToSlide(api, slide, 0.93, 3.53, 4.19, 3.72);
+    addTextToParagraph(api, paragraph, texts[2], 72, textSpecialFill, false, "left", "Arial Black");
+    paragraph = addParagraphToSlide(api, slide, 7.97, 3.53, 5.12, 3.72);
+    addTextToParagraph(api, paragraph, texts[3], 72, textSpecialFill, false, "left", "Arial Black");
+    return slide;
+}
+
+// Duplicates the competitor slide `templateSlide` to `position` and replaces texts of its runs with data of `competitor`.
+// Shapes, positions and run properties are copied with the slide, so only the texts are set.
+CValue duplicateCompetitorSlide(CValue templateSlide, int position, const json& competitor)
+{
+    vector<string> texts = getCompetitorTexts(competitor);
+    CValue slide = templateSlide.Call("Duplicate", position);
+    CValue shapes = slide.Call("GetAllShapes");
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        CValue run = shapes[competitorTextShapes[i]].Call("GetDocContent").Call("GetElement", 0).Call("GetElement", 0);
+        run.Call("ClearContent");
+        run.Call("AddText", texts[i].c_str());
+    }
+    apiCalls += 2 + texts.size() * 5;
+    return slide;
+}
+
+// Input data of the presentation
+struct CStartupData
+{
+    json market;            // Statista API response
+    json competitors;       // Crunchbase API response
+    json audience;          // Social Media Insights API response
+    json searchTrends;      // Google Trends API response
+    json financialModel;    // data from financial system
+};
+
+bool loadJson(const string& path, json& data)
+{
+    ifstream fs(path);
+    if (!fs.is_open())
+        return false;
+    data = json::parse(fs);
+    return true;
+}
 
-    // init docbuilder and create new pptx file
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+// `competitorsPath` replaces Crunchbase API response from resources if it is not empty
+bool loadStartupData(const string& resourcesDir, const string& competitorsPath, CStartupData& data)
+{
+    return loadJson(resourcesDir + "/data/statista_api_response.json", data.market) &&
+           loadJson(competitorsPath.empty() ? resourcesDir + "/data/crunchbase_api_response.json" : competitorsPath, data.competitors) &&
+           loadJson(resourcesDir + "/data/smi_api_response.json", data.audience) &&
+           loadJson(resourcesDir + "/data/google_trends_api_response.json", data.searchTrends) &&
+           loadJson(resourcesDir + "/data/financial_model_data.json", data.financialModel);
+}
+
+// Creates new presentation in `builder` from `input`, the input is moved out while building.
+// Competitor slides are duplicated from the first one unless `constructive` is set, then every slide is built from shapes.
+// Time and number of API calls spent on competitor slides are added to `bench` if it is set.
+void buildPresentation(CDocBuilder& builder, CStartupData& input, bool constructive, NSUtils::CBenchTimer* bench = NULL)
+{
     builder.CreateFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX);
 
     CContext context = builder.GetContext();
+    CContextScope scope = context.CreateScope();
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
     CValue presentation = api.Call("GetPresentation");
@@ -136,9 +235,8 @@ int main()
     addTextToParagraph(api, paragraph, "12.12.2024", 48, textFill, false, "center");
 
     // MARKET OVERVIEW slide
-    // parse JSON, obtained as Statista API response
-    ifstream fs(resourcesDir + "/data/statista_api_response.json");
-    json data = json::parse(fs);
+    // JSON, obtained as Statista API response
+    json data = std::move(input.market);
     // create new slide
     slide = addNewSlide(api, backgroundFill);
     // title
@@ -174,10 +272,8 @@ int main()
     addTextToParagraph(api, paragraph, trendsText, 72, textSpecialFill, false, "center", "Arial Black");
 
     // COMPETITORS OVERVIEW section
-    // parse JSON, obtained as Statista API response
-    fs.close();
-    fs.open(resourcesDir + "/data/crunchbase_api_response.json");
-    data = json::parse(fs);
+    // JSON, obtained as Crunchbase API response
+    data = std::move(input.competitors);
     // create new slide
     slide = addNewSlide(api, backgroundFill);
     // title
@@ -211,40 +307,36 @@ int main()
     slide.Call("AddObject", chart);
 
     // create slide for every competitor with brief info
+    NSUtils::CStopwatch competitorsStopwatch;
+    size_t competitorsCalls = apiCalls;
+    int firstCompetitorSlide = 0;
+    if (!constructive)
+    {
+        firstCompetitorSlide = presentation.Call("GetSlidesCount").ToInt();
+        apiCalls++;
+    }
+    int competitorsCount = 0;
+    CValue templateSlide;
     for (const auto& competitor : data["competitors"])
     {
-        // create new slide
-        slide = addNewSlide(api, backgroundFill);
-        // title
-        paragraph = addParagraphToSlide(api, slide, 11.8, 0.8, 0.8, 0.4);
-        addTextToParagraph(api, paragraph, "Competitors Overview", 72, textFill, false, "center");
-        // header
-        paragraph = addParagraphToSlide(api, slide, 11.8, 0.8, 0.8, 1.2);
-        addTextToParagraph(api, paragraph, competitor["name"].get<string>(), 64, textFill, false, "center");
-        // recent funding
-        paragraph = addParagraphToSlide(api, slide, 3.13, 0.8, 1.07, 2.65);
-        addTextToParagraph(api, paragraph, "Recent funding:", 48, textFill);
-        paragraph = addParagraphToSlide(api, slide, 8.9, 0.8, 4.19, 2.52);
-        addTextToParagraph(api, paragraph, competitor["recent_funding"].get<string>(), 96, textSpecialFill, false, "left", "Arial Black");
-        // main products
-        paragraph = addParagraphToSlide(api, slide, 3.13, 0.8, 1.07, 3.72);
-        addTextToParagraph(api, paragraph, "Main products:", 48, textFill);
-        paragraph = addParagraphToSlide(api, slide, 0.93, 3.53, 4.19, 3.72);
-        addTextToParagraph(api, paragraph, makeBulletString('>', (int)competitor["products"].size()), 72, textSpecialFill, false, "left", "Arial Black");
-        paragraph = addParagraphToSlide(api, slide, 7.97, 3.53, 5.12, 3.72);
-        string productsText;
-        for (const auto& product : competitor["products"])
-        {
-            productsText += product.get<string>() + "\n";
-        }
-        addTextToParagraph(api, paragraph, productsText, 72, textSpecialFill, false, "left", "Arial Black");
+        if (constructive || competitorsCount == 0)
+            templateSlide = addCompetitorSlide(api, competitor, backgroundFill, textFill, textSpecialFill);
+        else
+            duplicateCompetitorSlide(templateSlide, firstCompetitorSlide + competitorsCount, competitor);
+        competitorsCount++;
+    }
+    if (bench)
+    {
+        double ms = competitorsStopwatch.GetElapsedMs();
+        competitorsCalls = apiCalls - competitorsCalls;
+        printf("%d competitor slides %s in %.0f ms, %zu API calls\n", competitorsCount, constructive ? "built" : "duplicated", ms, competitorsCalls);
+        bench->Add("competitor_slides", ms, "ms");
+        bench->Add("competitor_calls", (double)competitorsCalls, "count");
     }
 
     // TARGET AUDIENCE section
-    // parse JSON, obtained as Social Media Insights API response
-    fs.close();
-    fs.open(resourcesDir + "/data/smi_api_response.json");
-    data = json::parse(fs);
+    // JSON, obtained as Social Media Insights API response
+    data = std::move(input.audience);
     // create new slide
     slide = addNewSlide(api, backgroundFill);
     // title
@@ -295,10 +387,8 @@ int main()
     addTextToParagraph(api, paragraph, negativeFeedback, 52, textAltFill, false, "left", "Arial Black");
 
     // SEARCH TRENDS section
-    // parse JSON, obtained as Google Trends API response
-    fs.close();
-    fs.open(resourcesDir + "/data/google_trends_api_response.json");
-    data = json::parse(fs);
+    // JSON, obtained as Google Trends API response
+    data = std::move(input.searchTrends);
     // create new slide
     slide = addNewSlide(api, backgroundFill);
     // title
@@ -316,10 +406,8 @@ int main()
     }
 
     // FINANCIAL MODEL section
-    // parse JSON, obtained from financial system
-    fs.close();
-    fs.open(resourcesDir + "/data/financial_model_data.json");
-    data = json::parse(fs);
+    // JSON, obtained from financial system
+    data = std::move(input.financialModel);
     // create new slide
     slide = addNewSlide(api, backgroundFill);
     // title
@@ -331,20 +419,19 @@ int main()
     // chart
     vector<string> chartKeys = { "revenue", "cost_of_goods_sold", "gross_profit", "operating_expenses", "net_profit" };
     const json& profitForecast = data["profit_forecast"];
-    CValue arrChartYears = CValue::CreateArray((int)profitForecast.size());
-    for (int i = 0; i < (int)profitForecast.size(); i++)
-    {
-        arrChartYears[i] = profitForecast[i]["year"].get<string>().c_str();
-    }
-    arrChartData = CValue::CreateArray((int)chartKeys.size());
-    for (int i = 0; i < (int)chartKeys.size(); i++)
+    // table of the forecast: year and values of chart keys in every row
+    NSUtils::CMatrix<string> forecastTable(profitForecast.size(), chartKeys.size() + 1);
+    for (size_t i = 0; i < profitForecast.size(); i++)
     {
-        arrChartData[i] = CValue::CreateArray((int)profitForecast.size());
-        for (int j = 0; j < (int)profitForecast.size(); j++)
+        forecastTable(i, 0) = profitForecast[i]["year"].get<string>();
+        for (size_t j = 0; j < chartKeys.size(); j++)
         {
-            arrChartData[i][j] = profitForecast[j][chartKeys[i]].get<string>().c_str();
+            forecastTable(i, j + 1) = profitForecast[i][chartKeys[j]].get<string>();
         }
     }
+    // series of the chart are columns of the table
+    CValue arrChartYears = NSUtils::ToValue(context, forecastTable.GetColumn(0));
+    arrChartData = NSUtils::ToValue(context, forecastTable.GetView().GetSubView(0, 1).GetTransposed());
     CValue arrChartNames = createStringArray({ "Revenue", "Cost of goods sold", "Gross profit", "Operating expenses", "Net profit" });
     chart = api.Call("CreateChart", "lineNormal", arrChartData, arrChartNames, arrChartYears);
     setChartSizes(chart, 10.06, 5.06, 1.67, 2);
@@ -374,19 +461,17 @@ int main()
     double variableCostPerUnit = stod(separateValueAndUnit(data["break_even_analysis"]["variable_cost_per_unit"].get<string>()).first);
     int breakEvenPoint = data["break_even_analysis"]["break_even_point"].get<int>();
     int step = breakEvenPoint / 4;
-    CValue chartUnits = context.CreateArray(9);
-    CValue chartRevenue = context.CreateArray(9);
-    CValue chartTotalCosts = context.CreateArray(9);
+    // units, revenue and total costs in every row
+    NSUtils::CMatrix<int> breakEvenTable(9, 3);
     for (int i = 0; i < 9; i++)
     {
         int currUnits = i * step;
-        chartUnits[i] = currUnits;
-        chartRevenue[i] = (int)(currUnits * sellingPricePerUnit);
-        chartTotalCosts[i] = (int)(fixedCosts + currUnits * variableCostPerUnit);
+        breakEvenTable(i, 0) = currUnits;
+        breakEvenTable(i, 1) = (int)(currUnits * sellingPricePerUnit);
+        breakEvenTable(i, 2) = (int)(fixedCosts + currUnits * variableCostPerUnit);
     }
-    arrChartData = CValue::CreateArray(2);
-    arrChartData[0] = chartRevenue;
-    arrChartData[1] = chartTotalCosts;
+    CValue chartUnits = NSUtils::ToValue(context, breakEvenTable.GetColumn(0));
+    arrChartData = NSUtils::ToValue(context, breakEvenTable.GetView().GetSubView(0, 1).GetTransposed());
     arrChartNames = createStringArray({ "Revenue", "Total costs" });
     // create chart
     chart = api.Call("CreateChart", "lineNormal", arrChartData, arrChartNames, chartUnits);
@@ -417,25 +502,148 @@ int main()
     addTextToParagraph(api, paragraph, "Growth rates", 48, textFill, false, "center");
     // chart
     const json& growthRates = data["growth_rates"];
-    arrChartYears = CValue::CreateArray((int)growthRates.size());
-    CValue arrChartGrowth = CValue::CreateArray((int)growthRates.size());
-    for (int i = 0; i < (int)growthRates.size(); i++)
+    NSUtils::CMatrix<string> growthTable(growthRates.size(), 2);
+    for (size_t i = 0; i < growthRates.size(); i++)
     {
-        arrChartYears[i] = growthRates[i]["year"].get<string>().c_str();
-        arrChartGrowth[i] = growthRates[i]["growth"].get<string>().c_str();
+        growthTable(i, 0) = growthRates[i]["year"].get<string>();
+        growthTable(i, 1) = growthRates[i]["growth"].get<string>();
     }
-    arrChartData = CValue::CreateArray(1);
-    arrChartData[0] = arrChartGrowth;
+    arrChartYears = NSUtils::ToValue(context, growthTable.GetColumn(0));
+    arrChartData = NSUtils::ToValue(context, growthTable.GetView().GetSubView(0, 1).GetTransposed());
     chart = api.Call("CreateChart", "lineNormal", arrChartData, CValue::CreateArray(0), arrChartYears);
     setChartSizes(chart, 10.06, 5.06, 1.67, 2);
     chart.Call("SetVerAxisTitle", "Growth (%)", 14, false);
     chart.Call("SetHorAxisTitle", "Year", 14, false);
     chart.Call("SetMinorVerticalGridlines", stroke);
     slide.Call("AddObject", chart);
+}
+
+// Generates `count` presentations one after another: every input is loaded, built and saved before the next one.
+// Saved presentations are named result_<index>.pptx.
+void runSequential(NSUtils::CBuilderGovernor& governor, const string& resourcesDir, const string& competitorsPath, bool constructive, int count, NSUtils::CLatencyStats& latency)
+{
+    for (int i = 0; i < count; i++)
+    {
+        NSUtils::CStopwatch stopwatch;
+        CStartupData input;
+        if (!loadStartupData(resourcesDir, competitorsPath, input))
+            continue;
+        CDocBuilder& builder = governor.GetBuilder();
+        buildPresentation(builder, input, constructive);
+        wstring path = L"result_" + to_wstring(i) + L".pptx";
+        int error = builder.SaveFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX, path.c_str());
+        builder.CloseFile();
+        if (error == 0)
+            latency.Add(stopwatch.GetElapsedMs());
+        governor.AfterJob();
+    }
+}
+
+// Generates the same presentations as runSequential(), but loading of the next inputs and writing of the saved
+// presentations run on I/O threads while the builder builds. The builder saves to the memory-backed temporary
+// directory, and the file is moved to its place by I/O thread.
+void runPipeline(NSUtils::CBuilderGovernor& governor, const string& resourcesDir, const string& competitorsPath, bool constructive, int count, int ioThreads, NSUtils::CLatencyStats& latency)
+{
+    // only the next input is loaded ahead: loading more of them adds their waiting time to latency without raising throughput
+    NSUtils::CDocumentPipeline<CStartupData> pipeline(ioThreads, 1);
+    pipeline.Run(
+        count,
+        [&resourcesDir, &competitorsPath](size_t, CStartupData& input) {
+            return loadStartupData(resourcesDir, competitorsPath, input);
+        },
+        [&governor, constructive](size_t, CStartupData& input) {
+            CDocBuilder& builder = governor.GetBuilder();
+            buildPresentation(builder, input, constructive);
+            string path = NSUtils::SaveFileToTmp(builder, OFFICESTUDIO_FILE_PRESENTATION_PPTX, NULL);
+            builder.CloseFile();
+            governor.AfterJob();
+            return path;
+        },
+        [](size_t index, const string& path) {
+            return NSUtils::MoveSavedFile(path, "result_" + to_string(index) + ".pptx");
+        },
+        latency);
+}
+
+// Main function
+// Usage: creating_startup_presentation [--pipeline N] [--io-threads K] [--recycle-jobs J] [--recycle-memory MB] [--constructive] [--competitors PATH]
+//   --pipeline N        - generate N presentations, first one after another and then in the pipeline, and print latency percentiles
+//   --io-threads K      - number of threads loading inputs and writing outputs in the pipeline (2 by default)
+//   --recycle-jobs J    - dispose and initialize the builder again after every J presentations
+//   --recycle-memory MB - dispose and initialize the builder again when resident memory is above MB megabytes
+//   --constructive      - build every competitor slide from shapes instead of duplicating the first one
+//   --competitors PATH  - read competitors from another Crunchbase API response (e.g. generated by configure/generate_data.py)
+int main(int argc, char* argv[])
+{
+    int pipelineCount = 0;
+    int ioThreads = 2;
+    NSUtils::CRecycleLimits recycle = { 0, 0 };
+    bool constructive = false;
+    string competitorsPath;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--pipeline" && i + 1 < argc)
+            pipelineCount = max(atoi(argv[++i]), 1);
+        else if (arg == "--io-threads" && i + 1 < argc)
+            ioThreads = max(atoi(argv[++i]), 1);
+        else if (arg == "--recycle-jobs" && i + 1 < argc)
+            recycle.maxJobs = (size_t)max(atoi(argv[++i]), 0);
+        else if (arg == "--recycle-memory" && i + 1 < argc)
+            recycle.maxResidentKB = (size_t)max(atoi(argv[++i]), 0) * 1024;
+        else if (arg == "--constructive")
+            constructive = true;
+        else if (arg == "--competitors" && i + 1 < argc)
+            competitorsPath = argv[++i];
+    }
+    NSUtils::CBenchTimer bench("creating_startup_presentation");
+    string resourcesDir = U_TO_UTF8(NSUtils::GetResourcesDirectory());
+
+    // init docbuilder
+    NSUtils::CSampleEngine engine(workDir);
+    bench.Phase("init");
+
+    if (pipelineCount > 0)
+    {
+        NSUtils::CLatencyStats sequentialLatency;
+        NSUtils::CLatencyStats pipelineLatency;
+        double sequentialMs = 0;
+        double pipelineMs = 0;
+        {
+            // the only builder of the process, so the governor may dispose and initialize the engine,
+            // unless the engine is shared with other samples by docgen
+            NSUtils::CBuilderGovernor governor(recycle, engine.IsOwner() ? workDir : NULL);
+            runSequential(governor, resourcesDir, competitorsPath, constructive, pipelineCount, sequentialLatency);
+            sequentialMs = bench.Phase("sequential");
+            runPipeline(governor, resourcesDir, competitorsPath, constructive, pipelineCount, ioThreads, pipelineLatency);
+            pipelineMs = bench.Phase("pipeline");
+            governor.Report(bench);
+        }
+
+        sequentialLatency.Report(bench, "latency sequential");
+        pipelineLatency.Report(bench, "latency pipeline");
+        printf("sequential: %.0f ms, %.2f presentations/s\n", sequentialMs, pipelineCount * 1000.0 / sequentialMs);
+        printf("pipeline:   %.0f ms, %.2f presentations/s\n", pipelineMs, pipelineCount * 1000.0 / pipelineMs);
+        engine.Dispose();
+        return 0;
+    }
+
+    CDocBuilder& builder = engine.GetBuilder();
+    CStartupData input;
+    if (!loadStartupData(resourcesDir, competitorsPath, input))
+    {
+        fprintf(stderr, "Failed to read data from %s/data\n", resourcesDir.c_str());
+        engine.Dispose();
+        return 1;
+    }
+    bench.Phase("parse");
+    buildPresentation(builder, input, constructive, &bench);
+    bench.Phase("build");
 
     // save and close
     builder.SaveFile(OFFICESTUDIO_FILE_PRESENTATION_PPTX, resultPath);
+    bench.Phase("save");
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
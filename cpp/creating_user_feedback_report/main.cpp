@@ -30,6 +30,9 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/output_cache.h"
 #include "resources/utils/json/json.hpp"
 
 using namespace std;
@@ -44,6 +47,9 @@ CValue color_orange;
 CValue color_grey;
 CValue color_blue;
 
+// Number of API calls made to highlight users with low ratings
+int highlightCalls = 0;
+
 // Helper functions
 string doubleToString(double value, int precision = 1) {
     std::ostringstream oss;
@@ -62,6 +68,24 @@ CValue getArrayRow(const vector<string>& row_data) {
     return row;
 }
 
+// Adds conditional formatting rule highlighting the rows of users with average rating <= 2.
+// Average rating is written only to the first row of the merged user block, so the rule looks up the last
+// value of the column within `maxBlockSize` rows above. The number of calls doesn't depend on the number of rows.
+void addLowRatingFormatting(CValue worksheet, int startRow, int endRow, int ratingCol, int maxBlockSize) {
+    CValue range = worksheet.Call(
+        "GetRange",
+        worksheet.Call("GetRangeByNumber", startRow, 0),
+        worksheet.Call("GetRangeByNumber", endRow, ratingCol)
+    );
+    // formula is relative to the first cell of the range, rows are 1-based
+    string column = string(1, (char)('A' + ratingCol));
+    string firstRow = to_string(startRow + 1);
+    string formula = "=LOOKUP(9.99E+307,INDEX($" + column + ":$" + column + ",MAX(" + firstRow + ",ROW()-" +
+        to_string(maxBlockSize - 1) + ")):$" + column + firstRow + ")<=2";
+    range.Call("GetFormatConditions").Call("Add", "xlExpression", "", formula.c_str()).Call("SetFillColor", color_orange);
+    highlightCalls += 6;
+}
+
 void setTableStyle(CValue range) {
     range.Call("SetRowHeight", 24);
     range.Call("SetAlignVertical", "center");
@@ -75,29 +99,97 @@ void setTableStyle(CValue range) {
     range.Call("SetBorders", "InsideVertical", lineStyle.c_str(), color_black);
 }
 
-int fillAverageSheet(CValue worksheet, json& feedbackData) {
-    map<string, vector<int>> result;
-    vector<string> questionOrder;
+// Sums and counts of ratings grouped by key (question or date) in order of appearance.
+// They are saved next to the report, so new records can be added without reading the old ones.
+class CRatings {
+public:
+    vector<string> keys;
+    map<string, pair<int, int>> values;
+
+    void add(const string& key, int rating) {
+        auto it = values.find(key);
+        if (it == values.end()) {
+            keys.push_back(key);
+            it = values.insert(make_pair(key, make_pair(0, 0))).first;
+        }
+        it->second.first += rating;
+        it->second.second += 1;
+    }
 
-    for (const auto& record : feedbackData) {
-        for (const auto& item : record["feedback"]) {
-            string question = item["question"].get<string>();
-            int rating = item["answer"]["rating"].get<int>();
+    string getAverage(const string& key) {
+        const pair<int, int>& value = values[key];
+        return doubleToString((double)value.first / value.second);
+    }
 
-            if (result.find(question) == result.end()) {
-                questionOrder.push_back(question);
+    json toJson() const {
+        json result = json::array();
+        for (const auto& key : keys) {
+            const pair<int, int>& value = values.at(key);
+            result.push_back({{"key", key}, {"sum", value.first}, {"count", value.second}});
+        }
+        return result;
+    }
+
+    void fromJson(const json& data) {
+        for (const auto& item : data) {
+            string key = item["key"].get<string>();
+            keys.push_back(key);
+            values[key] = make_pair(item["sum"].get<int>(), item["count"].get<int>());
+        }
+    }
+};
+
+// State of the report required for appending new records
+struct CReportState {
+    CRatings questions;
+    CRatings dates;
+    // number of filled rows on the Comments sheet including the header
+    int commentsRowsCount = 1;
+
+    void addRecords(const json& feedbackData) {
+        for (const auto& record : feedbackData) {
+            commentsRowsCount += (int)record["feedback"].size();
+            string date = record["date"].get<string>();
+            for (const auto& item : record["feedback"]) {
+                int rating = item["answer"]["rating"].get<int>();
+                questions.add(item["question"].get<string>(), rating);
+                dates.add(date, rating);
             }
-            result[question].push_back(rating);
         }
     }
 
-    int questionSize = (int)questionOrder.size();
+    bool load(const string& path) {
+        ifstream fs(path);
+        if (!fs.is_open())
+            return false;
+        json data = json::parse(fs, nullptr, false);
+        if (data.is_discarded() || !data.is_object())
+            return false;
+        questions.fromJson(data["questions"]);
+        dates.fromJson(data["dates"]);
+        commentsRowsCount = data["comments_rows"].get<int>();
+        return true;
+    }
+
+    void save(const string& path) const {
+        json data = {
+            {"questions", questions.toJson()},
+            {"dates", dates.toJson()},
+            {"comments_rows", commentsRowsCount}
+        };
+        ofstream fs(path);
+        fs << data.dump(4);
+    }
+};
+
+// Writes average ratings of all questions. It depends only on the number of questions, not records.
+int fillAverageSheet(CValue worksheet, CRatings& questions) {
+    int questionSize = (int)questions.keys.size();
     CValue averageValues = CValue::CreateArray(questionSize + 1);
     averageValues[0] = getArrayRow({"Question", "Average Rating", "Number of Responses"});
     for (int i = 0; i < questionSize; i++) {
-        vector<int>& ratings = result[questionOrder[i]];
-        string average = doubleToString((double)accumulate(ratings.begin(), ratings.end(), 0) / ratings.size());
-        averageValues[i + 1] = getArrayRow({questionOrder[i], average, to_string(ratings.size())});
+        const string& question = questions.keys[i];
+        averageValues[i + 1] = getArrayRow({question, questions.getAverage(question), to_string(questions.values[question].second)});
     }
 
     int colsCount = averageValues[0].GetLength() - 1;
@@ -126,26 +218,34 @@ int fillAverageSheet(CValue worksheet, json& feedbackData) {
     return rowsCount;
 }
 
-int fillPersonalRatingsAndComments(CValue worksheet, json& feedbackData) {
-    CValue headerValues = CValue::CreateArray(1);
-    headerValues[0] = getArrayRow({"Date", "Question", "Comment", "Rating", "Average User Rating"});
-    int colsCount = headerValues[0].GetLength() - 1;
-    CValue startCell = worksheet.Call("GetRangeByNumber", 0, 0);
-    CValue headerRow = worksheet.Call(
-        "GetRange",
-        startCell,
-        worksheet.Call("GetRangeByNumber", 0, colsCount)
-    );
+// Writes records starting from `rowsCount` row of the Comments sheet, which is 1 for the new sheet.
+// Users with low ratings are highlighted by the conditional formatting rule, or with SetFillColor
+// for every user if `directFill` is set. Returns the number of filled rows.
+int fillPersonalRatingsAndComments(CValue worksheet, const json& feedbackData, bool directFill, int rowsCount = 1) {
+    int colsCount = 4;
+    int startRow = rowsCount;
+    int maxBlockSize = 1;
+    if (startRow == 1) {
+        CValue headerValues = CValue::CreateArray(1);
+        headerValues[0] = getArrayRow({"Date", "Question", "Comment", "Rating", "Average User Rating"});
+        CValue headerRow = worksheet.Call(
+            "GetRange",
+            worksheet.Call("GetRangeByNumber", 0, 0),
+            worksheet.Call("GetRangeByNumber", 0, colsCount)
+        );
 
-    headerRow.Call("SetValue", headerValues);
-    headerRow.Call("SetBold", true);
+        headerRow.Call("SetValue", headerValues);
+        headerRow.Call("SetBold", true);
+        // the header is formatted with the rest of the table
+        startRow = 0;
+    }
 
-    int rowsCount = 1;
     for (const auto& record : feedbackData) {
         // Count and fill user feedback
         double avgRating = 0;
 
         int feedbackSize = (int)record["feedback"].size();
+        maxBlockSize = max(maxBlockSize, feedbackSize);
         CValue userFeedback = CValue::CreateArray(feedbackSize);
         int i = 0;
         for (const auto& item : record["feedback"]) {
@@ -187,34 +287,38 @@ int fillPersonalRatingsAndComments(CValue worksheet, json& feedbackData) {
         ratingCell.Call("SetValue", doubleToString(avgRating).c_str());
 
         // If rating <= 2, highlight it
-        if (avgRating <= 2) {
+        if (directFill && avgRating <= 2) {
             worksheet.Call(
                 "GetRange",
                 worksheet.Call("GetRangeByNumber", rowsCount, 0),
                 worksheet.Call("GetRangeByNumber", rowsCount + userRowsCount, colsCount)
             ).Call("SetFillColor", color_orange);
+            highlightCalls += 4;
         }
 
         // Update rows count
         rowsCount += feedbackSize;
     }
+    if (rowsCount == startRow || rowsCount == 1)
+        return rowsCount;
 
-    // Format table
-    rowsCount -= 1;
+    // Format only the added part of the table
     CValue resultRange = worksheet.Call(
         "GetRange",
-        startCell,
-        worksheet.Call("GetRangeByNumber", rowsCount, colsCount)
+        worksheet.Call("GetRangeByNumber", startRow, 0),
+        worksheet.Call("GetRangeByNumber", rowsCount - 1, colsCount)
     );
     setTableStyle(resultRange);
+    if (!directFill)
+        addLowRatingFormatting(worksheet, max(startRow, 1), rowsCount - 1, colsCount, maxBlockSize);
     worksheet.Call(
         "GetRange",
-        worksheet.Call("GetRangeByNumber", 1, colsCount - 1),
-        worksheet.Call("GetRangeByNumber", rowsCount, colsCount)
+        worksheet.Call("GetRangeByNumber", max(startRow, 1), colsCount - 1),
+        worksheet.Call("GetRangeByNumber", rowsCount - 1, colsCount)
     ).Call("SetAlignHorizontal", "center");
     resultRange.Call("AutoFit", false, true);
 
-    return rowsCount + 1;
+    return rowsCount;
 }
 
 void createColumnChart(CValue worksheet, string dataRange, string title) {
@@ -223,32 +327,22 @@ void createColumnChart(CValue worksheet, string dataRange, string title) {
     chart.Call("SetTitle", title.c_str(), 16);
 }
 
-void createLineChart(CValue api, CValue worksheet, json& feedbackData, string title) {
-    map<string, vector<int>> result;
-    vector<string> dateOrder;
-
-    for (const auto& record : feedbackData) {
-        string date = record["date"].get<string>();
-        if (result.find(date) == result.end()) {
-            dateOrder.push_back(date);
-        }
-        for (const auto& item : record["feedback"]) {
-            int rating = item["answer"]["rating"].get<int>();
-            result[date].push_back(rating);
-        }
-    }
-
-    int dateSize = (int)dateOrder.size();
+// Writes average rating of every day to the Charts sheet and returns the data range
+string fillDailyRatings(CValue worksheet, CRatings& dates) {
+    int dateSize = (int)dates.keys.size();
     CValue averageDayRating = CValue::CreateArray(dateSize + 1);
     averageDayRating[0] = getArrayRow({"Date", "Rating"});
     for (int i = 0; i < dateSize; i++) {
-        vector<int>& ratings = result[dateOrder[i]];
-        string average = doubleToString((double)accumulate(ratings.begin(), ratings.end(), 0) / ratings.size());
-        averageDayRating[i + 1] = getArrayRow({dateOrder[i], average});
+        averageDayRating[i + 1] = getArrayRow({dates.keys[i], dates.getAverage(dates.keys[i])});
     }
 
     string dataRange = "$E$1:$F$" + to_string(averageDayRating.GetLength());
     worksheet.Call("GetRange", dataRange.c_str()).Call("SetValue", averageDayRating);
+    return dataRange;
+}
+
+void createLineChart(CValue api, CValue worksheet, CRatings& dates, string title) {
+    string dataRange = fillDailyRatings(worksheet, dates);
     CValue chart = worksheet.Call("AddChart", ("Charts!" + dataRange).c_str(), false, "scatter", 2, 135.38 * 36000, 81.28 * 36000);
     chart.Call("SetPosition", 0, 0, 18, 0);
     chart.Call("SetSeriesFill", color_blue, 0, false);
@@ -263,7 +357,7 @@ void createLineChart(CValue api, CValue worksheet, json& feedbackData, string ti
     chart.Call("SetMajorHorizontalGridlines", api.Call("CreateStroke", 0, api.Call("CreateNoFill")));
 }
 
-void createPieChart(CValue api, CValue worksheet, string dataRange, string title) {
+void fillPieChartData(CValue worksheet, string dataRange) {
     CValue pieChartData = CValue::CreateArray(2);
     pieChartData[0] = getArrayRow({"Negative", "Neutral", "Positive"});
     pieChartData[1] = getArrayRow(
@@ -274,6 +368,10 @@ void createPieChart(CValue api, CValue worksheet, string dataRange, string title
         }
     );
     worksheet.Call("GetRange", "$A$1:$C$2").Call("SetValue", pieChartData);
+}
+
+void createPieChart(CValue api, CValue worksheet, string dataRange, string title) {
+    fillPieChartData(worksheet, dataRange);
 
     CValue chart = worksheet.Call("AddChart", "Charts!$A$1:$C$2", true, "pie", 2, 135.38 * 36000, 81.28 * 36000);
     chart.Call("SetPosition", 9, 0, 0, 0);
@@ -290,16 +388,86 @@ void createPieChart(CValue api, CValue worksheet, string dataRange, string title
     chart.Call("SetSeriesOutLine", stroke, 0, false);
 }
 
-int main() {
-    // parse JSON
+// Extends data ranges of the charts created by createColumnChart() and createLineChart()
+void extendChartRanges(CValue worksheet, int averageRowsCount, int datesRowsCount) {
+    CValue charts = worksheet.Call("GetAllCharts");
+    if (charts.GetLength() < 2)
+        return;
+
+    string lastAverageRow = to_string(averageRowsCount);
+    CValue columnChart = charts[0];
+    columnChart.Call("SetSeriaValues", ("Average!$B$2:$B$" + lastAverageRow).c_str(), 0);
+    columnChart.Call("SetCatFormula", ("Average!$A$2:$A$" + lastAverageRow).c_str());
+
+    string lastDateRow = to_string(datesRowsCount);
+    CValue lineChart = charts[1];
+    lineChart.Call("SetSeriaValues", ("Charts!$F$2:$F$" + lastDateRow).c_str(), 0);
+    lineChart.Call("SetXValues", ("Charts!$E$2:$E$" + lastDateRow).c_str());
+}
+
+// Usage: creating_user_feedback_report [--append] [--direct-fill] [data.json]
+//   --append      - add records from the data file to the report created by the previous run:
+//                   only new records are written to the Comments sheet, averages are updated from
+//                   the state saved next to the report and the chart ranges are extended
+//   --direct-fill - highlight every user with low rating with its own SetFillColor call instead of
+//                   adding conditional formatting rule to the Comments table
+int main(int argc, char* argv[]) {
+    NSUtils::CBenchTimer bench("creating_user_feedback_report");
     string jsonPath = U_TO_UTF8(NSUtils::GetResourcesDirectory()) + "/data/user_feedback_data.json";
+    bool append = false;
+    bool directFill = false;
+    highlightCalls = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--append")
+            append = true;
+        else if (arg == "--direct-fill")
+            directFill = true;
+        else
+            jsonPath = arg;
+    }
+
+    string resultPathA = U_TO_UTF8(wstring(resultPath));
+    string statePath = resultPathA + ".state.json";
+    CReportState state;
+    if (append && !state.load(statePath)) {
+        printf("No state of the previous report is found, creating new report\n");
+        append = false;
+    }
+
+    // parse JSON
     ifstream fs(jsonPath);
     json data = json::parse(fs);
+    int commentsStartRow = state.commentsRowsCount;
+    state.addRecords(data);
+    bench.Phase("parse");
+
+    // the report built from the same data is taken from the cache, if it is enabled
+    NSUtils::COutputCache cache("creating_user_feedback_report");
+    if (!append) {
+        cache.AddInput(jsonPath);
+        cache.AddData(directFill ? "--direct-fill" : "");
+        if (cache.Restore(resultPath, bench)) {
+            state.save(statePath);
+            return 0;
+        }
+    }
 
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
-    builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    if (append) {
+        if (builder.OpenFile(resultPath, L"") != 0) {
+            fprintf(stderr, "Failed to open %s\n", resultPathA.c_str());
+            engine.Dispose();
+            return 1;
+        }
+        // the file is saved again, so it mustn't be shared with the cached copy
+        NSUtils::COutputCache::Detach(resultPath);
+    } else {
+        builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
+    }
+    bench.Phase("init");
 
     CContext context = builder.GetContext();
     CValue global = context.GetGlobal();
@@ -311,31 +479,55 @@ int main() {
     color_grey = api.Call("CreateRGBColor", 128, 128, 128);
     color_blue = api.Call("CreateRGBColor", 91, 155, 213);
 
-    // Get current worksheet
-    CValue worksheet1 = api.Call("GetActiveSheet");
-
-    // Create worksheet with average values
-    worksheet1.Call("SetName", "Average");
-    int table1RowsCount = fillAverageSheet(worksheet1, data);
-
-    // Create worksheet with comments and personal ratings
-    api.Call("AddSheet", "Comments");
-    CValue worksheet2 = api.Call("GetActiveSheet");
-    int table2RowsCount = fillPersonalRatingsAndComments(worksheet2, data);
-
-    // Create worksheet with charts
-    api.Call("AddSheet", "Charts");
-    CValue worksheet3 = api.Call("GetActiveSheet");
-    createColumnChart(worksheet3, "Average!$A$2:$B$" + to_string(table1RowsCount), "Average ratings");
-    createLineChart(api, worksheet3, data, "Dynamics of the average ratings");
-    createPieChart(api, worksheet3, "Comments!$D$1:$D$" + to_string(table2RowsCount), "Shares of reviews");
+    CValue worksheet1;
+    if (append) {
+        // Update averages and add new records
+        worksheet1 = api.Call("GetSheet", "Average");
+        int table1RowsCount = fillAverageSheet(worksheet1, state.questions);
+
+        CValue worksheet2 = api.Call("GetSheet", "Comments");
+        fillPersonalRatingsAndComments(worksheet2, data, directFill, commentsStartRow);
+
+        CValue worksheet3 = api.Call("GetSheet", "Charts");
+        fillDailyRatings(worksheet3, state.dates);
+        fillPieChartData(worksheet3, "Comments!$D$1:$D$" + to_string(state.commentsRowsCount));
+        extendChartRanges(worksheet3, table1RowsCount, (int)state.dates.keys.size() + 1);
+        bench.Add("appended_records", (double)data.size(), "count");
+    } else {
+        // Get current worksheet
+        worksheet1 = api.Call("GetActiveSheet");
+
+        // Create worksheet with average values
+        worksheet1.Call("SetName", "Average");
+        int table1RowsCount = fillAverageSheet(worksheet1, state.questions);
+
+        // Create worksheet with comments and personal ratings
+        api.Call("AddSheet", "Comments");
+        CValue worksheet2 = api.Call("GetActiveSheet");
+        fillPersonalRatingsAndComments(worksheet2, data, directFill);
+
+        // Create worksheet with charts
+        api.Call("AddSheet", "Charts");
+        CValue worksheet3 = api.Call("GetActiveSheet");
+        createColumnChart(worksheet3, "Average!$A$2:$B$" + to_string(table1RowsCount), "Average ratings");
+        createLineChart(api, worksheet3, state.dates, "Dynamics of the average ratings");
+        createPieChart(api, worksheet3, "Comments!$D$1:$D$" + to_string(state.commentsRowsCount), "Shares of reviews");
+    }
 
     // Set first worksheet active
     worksheet1.Call("SetActive");
+    bench.Add("highlight_calls", (double)highlightCalls, "count");
+    bench.Phase("build");
 
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath);
+    bench.Phase("save");
+    bench.AddFileSize("result_size", resultPathA);
+    state.save(statePath);
+    bench.Phase("save_state");
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
+    if (!append)
+        cache.Store(resultPath, bench.GetTotalMs());
     return 0;
 }
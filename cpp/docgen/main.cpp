@@ -0,0 +1,440 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "docbuilder.h"
+
+#include "out/cpp/builder_path.h"
+#include "resources/utils/utils.h"
+#include "resources/utils/batch.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/export.h"
+#include "resources/utils/governor.h"
+#include "resources/utils/image_cache.h"
+#include "resources/utils/image_resize.h"
+#include "resources/utils/json_stream.h"
+#include "resources/utils/matrix.h"
+#include "resources/utils/memory_save.h"
+#include "resources/utils/methods.h"
+#include "resources/utils/output_cache.h"
+#include "resources/utils/pipeline.h"
+#include "resources/utils/recorder.h"
+#include "resources/utils/xlsx_reader.h"
+#include "resources/utils/json/json.hpp"
+
+#if defined(_LINUX) || defined(_MAC)
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// Every sample is compiled in its own namespace, so their helper functions and constants don't conflict.
+// All headers used by the samples are included above: included again inside the namespaces, they are skipped.
+namespace NSCommentingErrors
+{
+#include "cpp/commenting_errors/main.cpp"
+}
+namespace NSAdvancedForm
+{
+#include "cpp/creating_advanced_form/main.cpp"
+}
+namespace NSAnnualReport
+{
+#include "cpp/creating_annual_report/main.cpp"
+}
+namespace NSBasicForm
+{
+#include "cpp/creating_basic_form/main.cpp"
+}
+namespace NSChartPresentation
+{
+#include "cpp/creating_chart_presentation/main.cpp"
+}
+namespace NSCommercialOffer
+{
+#include "cpp/creating_commercial_offer/main.cpp"
+}
+namespace NSDevelopmentPlan
+{
+#include "cpp/creating_development_plan/main.cpp"
+}
+namespace NSEmploymentAgreement
+{
+#include "cpp/creating_employment_agreement/main.cpp"
+}
+namespace NSInventoryReport
+{
+#include "cpp/creating_inventory_report/main.cpp"
+}
+namespace NSInvestmentPlan
+{
+#include "cpp/creating_investment_plan/main.cpp"
+}
+namespace NSInvoice
+{
+#include "cpp/creating_invoice/main.cpp"
+}
+namespace NSPresentation
+{
+#include "cpp/creating_presentation/main.cpp"
+}
+namespace NSStartupPresentation
+{
+#include "cpp/creating_startup_presentation/main.cpp"
+}
+namespace NSUserFeedbackReport
+{
+#include "cpp/creating_user_feedback_report/main.cpp"
+}
+namespace NSFillingForm
+{
+#include "cpp/filling_form/main.cpp"
+}
+namespace NSFillingSpreadsheet
+{
+#include "cpp/filling_spreadsheet/main.cpp"
+}
+
+using namespace std;
+using namespace NSDoctRenderer;
+
+const wchar_t* workDir = BUILDER_DIR;
+
+typedef int (*CSampleMain)(int argc, char* argv[]);
+
+struct CSample
+{
+    const char* name;
+    CSampleMain run;
+};
+
+const CSample samples[] = {
+    { "commenting_errors", [](int, char**) { return NSCommentingErrors::main(); } },
+    { "creating_advanced_form", [](int, char**) { return NSAdvancedForm::main(); } },
+    { "creating_annual_report", NSAnnualReport::main },
+    { "creating_basic_form", [](int, char**) { return NSBasicForm::main(); } },
+    { "creating_chart_presentation", NSChartPresentation::main },
+    { "creating_commercial_offer", NSCommercialOffer::main },
+    { "creating_development_plan", NSDevelopmentPlan::main },
+    { "creating_employment_agreement", NSEmploymentAgreement::main },
+    { "creating_inventory_report", NSInventoryReport::main },
+    { "creating_investment_plan", [](int, char**) { return NSInvestmentPlan::main(); } },
+    { "creating_invoice", NSInvoice::main },
+    { "creating_presentation", NSPresentation::main },
+    { "creating_startup_presentation", NSStartupPresentation::main },
+    { "creating_user_feedback_report", NSUserFeedbackReport::main },
+    { "filling_form", NSFillingForm::main },
+    { "filling_spreadsheet", [](int, char**) { return NSFillingSpreadsheet::main(); } }
+};
+const int samplesCount = sizeof(samples) / sizeof(samples[0]);
+
+// One run of a sample: arguments[0] is the name of the sample
+struct CJob
+{
+    const CSample* sample;
+    vector<string> arguments;
+    string label;
+    double ms;
+    double separateMs;
+    int result;
+};
+
+const CSample* findSample(const string& name)
+{
+    for (int i = 0; i < samplesCount; i++)
+    {
+        if (name == samples[i].name)
+            return &samples[i];
+    }
+    return NULL;
+}
+
+bool addJob(vector<CJob>& jobs, const vector<string>& arguments)
+{
+    const CSample* sample = findSample(arguments[0]);
+    if (!sample)
+    {
+        fprintf(stderr, "Unknown sample: %s (see docgen --list)\n", arguments[0].c_str());
+        return false;
+    }
+    CJob job;
+    job.sample = sample;
+    job.arguments = arguments;
+    job.label = arguments[0];
+    for (size_t i = 1; i < arguments.size(); i++)
+        job.label += " " + arguments[i];
+    job.ms = 0;
+    job.separateMs = -1;
+    job.result = 0;
+    jobs.push_back(job);
+    return true;
+}
+
+// Reads jobs from the file: one sample with its arguments separated by spaces per line, # starts a comment
+bool readJobs(const string& path, vector<CJob>& jobs)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return false;
+    }
+    string line;
+    while (getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        istringstream words(line);
+        vector<string> arguments;
+        string word;
+        while (words >> word)
+            arguments.push_back(word);
+        if (!arguments.empty() && !addJob(jobs, arguments))
+            return false;
+    }
+    return true;
+}
+
+// Every sample writes its results to the working directory, so every job is run in its own directory
+bool enterJobDirectory(const string& outDir, const CJob& job, string& previousDir)
+{
+    string dir = outDir + "/" + job.sample->name;
+#if defined(_LINUX) || defined(_MAC)
+    char buffer[4096];
+    if (!getcwd(buffer, sizeof(buffer)))
+        return false;
+    previousDir = buffer;
+    mkdir(outDir.c_str(), 0755);
+    mkdir(dir.c_str(), 0755);
+    return chdir(dir.c_str()) == 0;
+#else
+    char buffer[MAX_PATH];
+    if (!_getcwd(buffer, sizeof(buffer)))
+        return false;
+    previousDir = buffer;
+    _mkdir(outDir.c_str());
+    _mkdir(dir.c_str());
+    return _chdir(dir.c_str()) == 0;
+#endif
+}
+
+void leaveJobDirectory(const string& previousDir)
+{
+#if defined(_LINUX) || defined(_MAC)
+    if (chdir(previousDir.c_str()) != 0)
+        fprintf(stderr, "Failed to return to %s\n", previousDir.c_str());
+#else
+    _chdir(previousDir.c_str());
+#endif
+}
+
+int runJob(CJob& job)
+{
+    vector<char*> argv;
+    for (size_t i = 0; i < job.arguments.size(); i++)
+        argv.push_back(&job.arguments[i][0]);
+    argv.push_back(NULL);
+    return job.sample->run((int)job.arguments.size(), &argv[0]);
+}
+
+// Runs the job by the executable of the sample built next to docgen (out/cpp/<sample>/<build dir>/<sample>)
+// and returns its wall time, or -1 if it couldn't be run
+double runSeparateJob(const CJob& job)
+{
+#if defined(_LINUX) || defined(_MAC)
+    string docgenDir = U_TO_UTF8(NSUtils::GetProcessDirectory());
+    string buildDir = docgenDir.substr(docgenDir.find_last_of('/') + 1);
+    string path = docgenDir + "/../../" + job.sample->name + "/" + buildDir + "/" + job.sample->name;
+    if (access(path.c_str(), X_OK) != 0)
+    {
+        fprintf(stderr, "%s is not built, it can't be compared\n", path.c_str());
+        return -1;
+    }
+
+    vector<char*> argv;
+    argv.push_back(&path[0]);
+    vector<string> arguments(job.arguments);
+    for (size_t i = 1; i < arguments.size(); i++)
+        argv.push_back(&arguments[i][0]);
+    argv.push_back(NULL);
+
+    NSUtils::CStopwatch stopwatch;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execv(argv[0], &argv[0]);
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "%s failed\n", job.label.c_str());
+        return -1;
+    }
+    return stopwatch.GetElapsedMs();
+#else
+    fprintf(stderr, "Running separate executables is supported only on Linux and Mac OS\n");
+    return -1;
+#endif
+}
+
+// Main function
+// Runs several samples in one process: the engine is initialized once and all samples use one builder.
+// Usage: docgen [--out DIR] [--jobs FILE] [--compare] [--list] [SAMPLE ...]
+//   SAMPLE      - name of the sample to run (e.g. creating_invoice), all samples are run if none are given
+//   --jobs FILE - read jobs from FILE: name of the sample and its arguments on every line
+//   --out DIR   - write results of every sample to DIR/<sample> (current directory by default)
+//   --compare   - run every job by the executable of the sample too and compare the times
+//   --list      - print names of the samples
+int main(int argc, char* argv[])
+{
+    NSUtils::HandleExportHelper(argc, argv, workDir);
+
+    vector<CJob> jobs;
+    string outDir = ".";
+    bool compare = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc)
+        {
+            if (!readJobs(argv[++i], jobs))
+                return 1;
+        }
+        else if (arg == "--out" && i + 1 < argc)
+            outDir = argv[++i];
+        else if (arg == "--compare")
+            compare = true;
+        else if (arg == "--list")
+        {
+            for (int j = 0; j < samplesCount; j++)
+                printf("%s\n", samples[j].name);
+            return 0;
+        }
+        else if (!addJob(jobs, vector<string>(1, arg)))
+            return 1;
+    }
+    if (jobs.empty())
+    {
+        for (int i = 0; i < samplesCount; i++)
+            addJob(jobs, vector<string>(1, samples[i].name));
+    }
+
+    NSUtils::CBenchTimer bench("docgen");
+    CDocBuilder::Initialize(workDir);
+    int failed = 0;
+    {
+        CDocBuilder builder;
+        NSUtils::CSampleEngine::SetSharedBuilder(&builder);
+        bench.Phase("init");
+
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            CJob& job = jobs[i];
+            string previousDir;
+            if (!enterJobDirectory(outDir, job, previousDir))
+            {
+                fprintf(stderr, "Failed to create directory for %s\n", job.label.c_str());
+                return 1;
+            }
+            NSUtils::CStopwatch stopwatch;
+            job.result = runJob(job);
+            job.ms = stopwatch.GetElapsedMs();
+            leaveJobDirectory(previousDir);
+            if (job.result != 0)
+                failed++;
+            bench.Add("job " + job.label, job.ms, "ms");
+        }
+        bench.Skip();
+        NSUtils::CSampleEngine::SetSharedBuilder(NULL);
+    }
+    CDocBuilder::Dispose();
+    bench.Phase("dispose");
+    double docgenMs = bench.GetTotalMs();
+
+    double separateMs = 0;
+    bool separateComplete = compare;
+    if (compare)
+    {
+        // separate executables are run after docgen, so they also find the files in the system cache
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            CJob& job = jobs[i];
+            string previousDir;
+            if (!enterJobDirectory(outDir, job, previousDir))
+                return 1;
+            job.separateMs = runSeparateJob(job);
+            leaveJobDirectory(previousDir);
+            if (job.separateMs < 0)
+            {
+                separateComplete = false;
+                continue;
+            }
+            separateMs += job.separateMs;
+            bench.Add("separate " + job.label, job.separateMs, "ms");
+        }
+        bench.Skip();
+    }
+
+    printf("\n%-48s %12s", "job", "docgen ms");
+    if (compare)
+        printf(" %12s", "separate ms");
+    printf("\n");
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        const CJob& job = jobs[i];
+        printf("%-48s %12.1f", job.label.c_str(), job.ms);
+        if (compare)
+        {
+            if (job.separateMs < 0)
+                printf(" %12s", "-");
+            else
+                printf(" %12.1f", job.separateMs);
+        }
+        printf("%s\n", job.result != 0 ? "  (failed)" : "");
+    }
+    printf("%-48s %12.1f", "total wall time", docgenMs);
+    if (separateComplete)
+        printf(" %12.1f\nspeedup: %.2fx", separateMs, separateMs / docgenMs);
+    printf("\n");
+    if (separateComplete)
+    {
+        bench.Add("separate total", separateMs, "ms");
+        bench.Add("speedup", separateMs / docgenMs, "x");
+    }
+    bench.Add("docgen total", docgenMs, "ms");
+    NSUtils::COutputCache::ReportRun(bench);
+    return failed == 0 ? 0 : 1;
+}
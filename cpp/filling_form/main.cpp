@@ -23,6 +23,11 @@
 
 #include "out/cpp/builder_path.h"
 #include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/engine.h"
+#include "resources/utils/image_cache.h"
+#include "resources/utils/image_resize.h"
+#include "resources/utils/memory_save.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -31,8 +36,21 @@ const wchar_t* workDir = BUILDER_DIR;
 const wchar_t* resultPath = L"result.docx";
 
 // Main function
-int main()
+int main(int argc, char* argv[])
 {
+    // with --stdout the document is written to standard output (e.g. a pipe) instead of result.docx
+    // with --no-downscale the image is used in its original size
+    bool toStdout = false;
+    bool downscale = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--stdout")
+            toStdout = true;
+        else if (string(argv[i]) == "--no-downscale")
+            downscale = false;
+    }
+    NSUtils::CBenchTimer bench("filling_form");
+
     std::map<wstring, wstring> formData;
     formData[L"Photo"] = L"https://static.onlyoffice.com/assets/docs/samples/img/onlyoffice_logo.png";
     formData[L"Serial"] = L"A1345";
@@ -46,9 +64,28 @@ int main()
     formData[L"Qty3"] = L"34";
     formData[L"Description3"] = L"Shifter";
 
+    // Download the image before building and use local copy
+    NSUtils::CImagePrefetcher images;
+    images.Add(U_TO_UTF8(formData[L"Photo"]));
+    images.Fetch(bench);
+    bench.Skip();
+    formData[L"Photo"] = images.Get(formData[L"Photo"]);
+
+    // The picture form of the template is 1800000 x 1800000 EMU, the image is scaled proportionally to fit it
+    if (downscale)
+    {
+        NSUtils::CImageDownscaler downscaler;
+        string photo = downscaler.Downscale(U_TO_UTF8(formData[L"Photo"]), 1800000, 1800000, true);
+        formData[L"Photo"] = NSUtils::GetStringFromUtf8((const unsigned char*)photo.c_str(), photo.length());
+        downscaler.Report(bench);
+        bench.Skip();
+    }
+
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
+    if (toStdout)
+        NSUtils::SetSaveTmpDirectory(builder);
     wstring templatePath = NSUtils::GetResourcesDirectory() + L"/docs/form.docx";
     builder.OpenFile(templatePath.c_str(), L"");
 
@@ -56,6 +93,8 @@ int main()
     CValue global = context.GetGlobal();
     CValue api = global["Api"];
 
+    bench.Phase("init");
+
     // Fill form
     CValue document = api.Call("GetDocument");
     CValue aForms = document.Call("GetAllForms");
@@ -71,9 +110,23 @@ int main()
         formNum++;
     }
 
+    bench.Phase("build");
+
     // Save and close
-    builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
+    bool saved = true;
+    if (toStdout)
+        saved = NSUtils::SaveFileToStdout(builder, OFFICESTUDIO_FILE_DOCUMENT_DOCX);
+    else
+        builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath);
+    bench.Phase(toStdout ? "save_stdout" : "save");
+    if (!toStdout)
+        bench.AddFileSize("result_size", U_TO_UTF8(wstring(resultPath)));
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
+    if (!saved)
+    {
+        fprintf(stderr, "Failed to write the document to standard output\n");
+        return 1;
+    }
     return 0;
 }
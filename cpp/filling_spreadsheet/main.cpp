@@ -21,6 +21,7 @@
 #include "docbuilder.h"
 
 #include "out/cpp/builder_path.h"
+#include "resources/utils/engine.h"
 
 using namespace std;
 using namespace NSDoctRenderer;
@@ -44,8 +45,8 @@ int main()
     };
 
     // Init DocBuilder
-    CDocBuilder::Initialize(workDir);
-    CDocBuilder builder;
+    NSUtils::CSampleEngine engine(workDir);
+    CDocBuilder& builder = engine.GetBuilder();
     builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
 
     CContext context = builder.GetContext();
@@ -81,6 +82,6 @@ int main()
     // Save and close
     builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath);
     builder.CloseFile();
-    CDocBuilder::Dispose();
+    engine.Dispose();
     return 0;
 }
@@ -0,0 +1,284 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common.h"
+#include "docbuilder.h"
+
+#include "out/cpp/builder_path.h"
+#include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/methods.h"
+#include "resources/utils/scheduler.h"
+#include "resources/utils/json/json.hpp"
+
+using namespace std;
+using namespace NSDoctRenderer;
+using json = nlohmann::json;
+namespace NSMethods = NSUtils::NSMethods;
+
+const wchar_t* workDir = BUILDER_DIR;
+
+// Input data shared by all jobs, read-only while jobs are running
+struct CJobsInput
+{
+    wstring formPath;
+    map<wstring, wstring> formData;
+    json inventory;
+};
+
+// Fills the form template like filling_form sample does
+void fillForm(CDocBuilder& builder, const CJobsInput& input, const wstring& resultPath)
+{
+    builder.OpenFile(input.formPath.c_str(), L"");
+    CContext context = builder.GetContext();
+    CContextScope scope = context.CreateScope();
+    CValue api = context.GetGlobal()["Api"];
+    CValue forms = api.Call("GetDocument").Call("GetAllForms");
+    for (int i = 0; i < (int)forms.GetLength(); i++)
+    {
+        CValue form = forms[i];
+        wstring type = form.Call("GetFormType").ToString().c_str();
+        map<wstring, wstring>::const_iterator value = input.formData.find(form.Call("GetFormKey").ToString().c_str());
+        if (type == L"textForm" && value != input.formData.end())
+            form.Call("SetText", value->second.c_str());
+    }
+    builder.SaveFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX, resultPath.c_str());
+    builder.CloseFile();
+}
+
+// Creates the inventory spreadsheet like creating_inventory_report sample does
+void createInventoryReport(CDocBuilder& builder, const CJobsInput& input, const wstring& resultPath)
+{
+    builder.CreateFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX);
+    CContext context = builder.GetContext();
+    CContextScope scope = context.CreateScope();
+    CValue api = context.GetGlobal()["Api"];
+    CValue worksheet = api.Call("GetActiveSheet");
+    worksheet.Call("GetRangeByNumber", 0, 0).Call("SetValue", "Item");
+    worksheet.Call("GetRangeByNumber", 0, 1).Call("SetValue", "Quantity");
+    worksheet.Call("GetRangeByNumber", 0, 2).Call("SetValue", "Status");
+    const json& inventory = input.inventory["inventory"];
+    for (int i = 0; i < (int)inventory.size(); i++)
+    {
+        const json& entry = inventory[i];
+        worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 0).Call(NSMethods::SetValue, entry["item"].get<string>().c_str());
+        worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 1).Call(NSMethods::SetValue, entry["quantity"].get<int>());
+        worksheet.Call(NSMethods::GetRangeByNumber, i + 1, 2).Call(NSMethods::SetValue, entry["status"].get<string>().c_str());
+    }
+    builder.SaveFile(OFFICESTUDIO_FILE_SPREADSHEET_XLSX, resultPath.c_str());
+    builder.CloseFile();
+}
+
+// Parses comma separated list of numbers
+vector<int> parseList(const string& value)
+{
+    vector<int> result;
+    stringstream stream(value);
+    string item;
+    while (getline(stream, item, ','))
+    {
+        if (atoi(item.c_str()) > 0)
+            result.push_back(atoi(item.c_str()));
+    }
+    return result;
+}
+
+// Submits a job generating the document `index`: forms and inventory reports by turns
+void submitJob(const CJobsInput& input, int index, const function<void(const NSUtils::CBuilderJob&)>& submit)
+{
+    if (index % 2 == 0)
+    {
+        wstring resultPath = L"result_form_" + to_wstring(index) + L".docx";
+        submit([&input, resultPath](CDocBuilder& builder) { fillForm(builder, input, resultPath); });
+    }
+    else
+    {
+        wstring resultPath = L"result_inventory_" + to_wstring(index) + L".xlsx";
+        submit([&input, resultPath](CDocBuilder& builder) { createInventoryReport(builder, input, resultPath); });
+    }
+}
+
+// Runs `jobsCount` jobs on every number of threads and prints the scaling curve
+void runScaling(NSUtils::CBenchTimer& bench, const CJobsInput& input, int jobsCount, const vector<int>& threadsCounts, const NSUtils::CRecycleLimits& recycle)
+{
+    double firstWallMs = 0;
+    for (size_t run = 0; run < threadsCounts.size(); run++)
+    {
+        int threads = threadsCounts[run];
+        NSUtils::CBuilderScheduler scheduler(threads, recycle);
+        scheduler.Start();
+        for (int i = 0; i < jobsCount; i++)
+        {
+            submitJob(input, i, [&scheduler](const NSUtils::CBuilderJob& job) { scheduler.Submit(job); });
+        }
+        scheduler.Wait();
+        scheduler.Stop();
+        scheduler.Report(bench);
+
+        if (run == 0)
+            firstWallMs = scheduler.GetWallMs() * threadsCounts[0];
+        double speedup = scheduler.GetWallMs() > 0 ? firstWallMs / scheduler.GetWallMs() : 0;
+        printf("  speedup %.2f, efficiency %.1f%%\n\n", speedup, speedup * 100.0 / threads);
+        bench.Add("speedup " + to_string(threads) + " threads", speedup, "x");
+    }
+}
+
+// Mixes interactive and batch load on the same workers: `jobsCount` inventory reports are submitted as a batch
+// at once, and forms are requested interactively every `intervalMs` while the batch is running.
+// Batch jobs are deferred when the queue is full, interactive requests are rejected.
+// With `fifo` both kinds of jobs have the same priority, which shows the latency without the priority queue.
+void runMixed(NSUtils::CBenchTimer& bench, const CJobsInput& input, int jobsCount, int threads, const NSUtils::CQueueLimits& limits,
+              const NSUtils::CRecycleLimits& recycle, int intervalMs, bool fifo)
+{
+    const int interactivePriority = 0;
+    const int batchPriority = fifo ? 0 : 1;
+    NSUtils::CPriorityBuilderQueue queue(threads, fifo ? 1 : 2, limits, recycle);
+
+    bool batchDone = false;
+    mutex batchMutex;
+    thread interactive([&]() {
+        for (int i = 0;; i += 2)
+        {
+            {
+                lock_guard<mutex> lock(batchMutex);
+                if (batchDone)
+                    break;
+            }
+            submitJob(input, i, [&queue, interactivePriority](const NSUtils::CBuilderJob& job) { queue.TrySubmit(interactivePriority, job); });
+            this_thread::sleep_for(chrono::milliseconds(intervalMs));
+        }
+    });
+
+    for (int i = 0; i < jobsCount; i++)
+    {
+        submitJob(input, i * 2 + 1, [&queue, batchPriority](const NSUtils::CBuilderJob& job) { queue.Submit(batchPriority, job); });
+    }
+    {
+        lock_guard<mutex> lock(batchMutex);
+        batchDone = true;
+    }
+    interactive.join();
+    queue.Stop();
+
+    // in fifo mode both kinds are in one queue, so their times are reported together
+    if (fifo)
+        queue.Report(bench, { "fifo" });
+    else
+        queue.Report(bench, { "interactive", "batch" });
+}
+
+// Main function
+// Usage: generating_documents_concurrently [--jobs N] [--threads 1,2,4,...]
+//        generating_documents_concurrently --mixed [--jobs N] [--threads T] [--max-queued Q] [--max-memory MB] [--aging-ms MS] [--interval-ms MS] [--fifo]
+// In both modes --recycle-jobs N and --recycle-memory MB make every worker replace its builder after N jobs
+// or when resident memory of the process is above the limit.
+// Generates N documents (forms and inventory reports by turns) on every number of threads from the list
+// and prints utilization of every thread and the scaling curve. By default the list is powers of two
+// up to the number of CPU cores.
+// With --mixed, N inventory reports are generated as a batch, while forms are requested interactively
+// (see runMixed()), and histograms of queue wait and service time are printed for both kinds of jobs.
+int main(int argc, char* argv[])
+{
+    NSUtils::CBenchTimer bench("generating_documents_concurrently");
+    int jobsCount = 64;
+    vector<int> threadsCounts;
+    bool mixed = false;
+    bool fifo = false;
+    int intervalMs = 50;
+    NSUtils::CQueueLimits limits = { 0, 0, 0, 2000 };
+    NSUtils::CRecycleLimits recycle = { 0, 0 };
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc)
+            jobsCount = max(atoi(argv[++i]), 1);
+        else if (arg == "--threads" && i + 1 < argc)
+            threadsCounts = parseList(argv[++i]);
+        else if (arg == "--mixed")
+            mixed = true;
+        else if (arg == "--fifo")
+            fifo = true;
+        else if (arg == "--max-queued" && i + 1 < argc)
+            limits.maxQueued = (size_t)max(atoi(argv[++i]), 1);
+        else if (arg == "--max-memory" && i + 1 < argc)
+            limits.maxResidentKB = (size_t)max(atoi(argv[++i]), 0) * 1024;
+        else if (arg == "--aging-ms" && i + 1 < argc)
+            limits.agingMs = max(atof(argv[++i]), 0.0);
+        else if (arg == "--interval-ms" && i + 1 < argc)
+            intervalMs = max(atoi(argv[++i]), 1);
+        else if (arg == "--recycle-jobs" && i + 1 < argc)
+            recycle.maxJobs = (size_t)max(atoi(argv[++i]), 0);
+        else if (arg == "--recycle-memory" && i + 1 < argc)
+            recycle.maxResidentKB = (size_t)max(atoi(argv[++i]), 0) * 1024;
+    }
+    if (threadsCounts.empty())
+    {
+        int cores = max((int)thread::hardware_concurrency(), 1);
+        for (int threads = 1; threads < cores; threads *= 2)
+            threadsCounts.push_back(threads);
+        threadsCounts.push_back(cores);
+    }
+
+    CJobsInput input;
+    wstring resourcesDir = NSUtils::GetResourcesDirectory();
+    input.formPath = resourcesDir + L"/docs/form.docx";
+    input.formData[L"Serial"] = L"A1345";
+    input.formData[L"Company Name"] = L"ONLYOFFICE";
+    input.formData[L"Date"] = L"25.12.2023";
+    input.formData[L"Recipient"] = L"Space Corporation";
+    input.formData[L"Qty1"] = L"25";
+    input.formData[L"Description1"] = L"Frame";
+    ifstream fs(U_TO_UTF8(resourcesDir) + "/data/ims_response.json");
+    input.inventory = json::parse(fs);
+
+    // The engine is initialized once for all workers
+    CDocBuilder::Initialize(workDir);
+    bench.Phase("init");
+
+    if (mixed)
+    {
+        // in mixed mode the last number of threads is used
+        int threads = threadsCounts.back();
+        // by default the batch may fill three quarters of the queue, and the rest is reserved for interactive requests
+        if (limits.maxQueued == 0)
+            limits.maxQueued = threads * 4;
+        if (!fifo)
+            limits.reserved = limits.maxQueued / 4;
+        runMixed(bench, input, jobsCount, threads, limits, recycle, intervalMs, fifo);
+        bench.Phase("mixed");
+    }
+    else
+    {
+        runScaling(bench, input, jobsCount, threadsCounts, recycle);
+        bench.Phase("jobs");
+    }
+
+    CDocBuilder::Dispose();
+    return 0;
+}
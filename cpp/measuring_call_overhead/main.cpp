@@ -0,0 +1,161 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include "common.h"
+#include "docbuilder.h"
+
+#include "out/cpp/builder_path.h"
+#include "resources/utils/utils.h"
+#include "resources/utils/bench.h"
+#include "resources/utils/methods.h"
+#include "resources/utils/matrix.h"
+
+using namespace std;
+using namespace NSDoctRenderer;
+namespace NSMethods = NSUtils::NSMethods;
+
+const wchar_t* workDir = BUILDER_DIR;
+
+// number of calls made between releasing of the created JS values
+const int callsPerScope = 10000;
+
+// Calls `call` for `count` times and prints the average cost of one call
+void measure(NSUtils::CBenchTimer& bench, CContext context, const string& name, int count, const function<void()>& call)
+{
+    NSUtils::CStopwatch stopwatch;
+    for (int done = 0; done < count;)
+    {
+        CContextScope scope = context.CreateScope();
+        int batchEnd = min(done + callsPerScope, count);
+        for (; done < batchEnd; done++)
+        {
+            call();
+        }
+    }
+    double ms = stopwatch.GetElapsedMs();
+    double nsPerCall = ms * 1000000.0 / count;
+    printf("%-36s %10d calls %10.1f ms %8.1f ns/call\n", name.c_str(), count, ms, nsPerCall);
+    bench.Add(name, nsPerCall, "ns/call");
+}
+
+// Measures conversion of `rows` x `cols` table to transposed nested arrays of chart data:
+//  - by cells: nested vectors are transposed by hand and every cell is assigned to CValue array;
+//  - bulk: the table is kept in CMatrix and its transposed view is converted with one call.
+void measureChartData(NSUtils::CBenchTimer& bench, CContext context, int rows, int cols)
+{
+    vector<vector<string>> table(rows, vector<string>(cols));
+    NSUtils::CMatrix<string> matrix(rows, cols);
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            table[i][j] = to_string((i * 31 + j * 17) % 100000) + ".25";
+            matrix(i, j) = table[i][j];
+        }
+    }
+    string size = to_string(rows) + "x" + to_string(cols);
+
+    CContextScope scope = context.CreateScope();
+    NSUtils::CStopwatch stopwatch;
+    CValue byCells = context.CreateArray(cols);
+    for (int j = 0; j < cols; j++)
+    {
+        CValue series = context.CreateArray(rows);
+        for (int i = 0; i < rows; i++)
+        {
+            series[i] = table[i][j].c_str();
+        }
+        byCells[j] = series;
+    }
+    double ms = stopwatch.GetElapsedMs();
+    printf("%-36s %10s cells %10.1f ms\n", "ChartData/by_cells", size.c_str(), ms);
+    bench.Add("ChartData/by_cells", ms, "ms");
+
+    stopwatch.Restart();
+    CValue bulk = NSUtils::ToValue(context, matrix.GetView().GetTransposed());
+    ms = stopwatch.GetElapsedMs();
+    printf("%-36s %10s cells %10.1f ms\n", "ChartData/bulk", size.c_str(), ms);
+    bench.Add("ChartData/bulk", ms, "ms");
+
+    if (bulk.GetLength() != byCells.GetLength() || bulk[cols - 1].GetLength() != byCells[cols - 1].GetLength())
+        fprintf(stderr, "Chart data conversions differ\n");
+}
+
+// Main function
+// Usage: measuring_call_overhead [calls count]
+// Measures the cost of CValue::Call for the methods used in hot loops of the samples:
+//  - by name: method is looked up by its string name on every call;
+//  - by method id: same call, but the name is compile-time constant from resources/utils/methods.h;
+//  - resolved function: method is resolved once and invoked through Function.prototype.call.
+// Then measures conversion of 10000 x 100 table to chart data (see measureChartData()).
+int main(int argc, char* argv[])
+{
+    NSUtils::CBenchTimer bench("measuring_call_overhead");
+    int count = argc > 1 ? max(atoi(argv[1]), 1) : 1000000;
+
+    // Init DocBuilder
+    CDocBuilder::Initialize(workDir);
+    CDocBuilder builder;
+    builder.CreateFile(OFFICESTUDIO_FILE_DOCUMENT_DOCX);
+
+    CContext context = builder.GetContext();
+    CValue global = context.GetGlobal();
+    CValue api = global["Api"];
+    CValue document = api.Call("GetDocument");
+    CValue paragraph = document.Call("GetElement", 0);
+    bench.Phase("init");
+
+    // setter without a result
+    measure(bench, context, "SetFontSize/by_name", count, [&]() {
+        paragraph.Call("SetFontSize", 24);
+    });
+    measure(bench, context, "SetFontSize/by_method_id", count, [&]() {
+        paragraph.Call(NSMethods::SetFontSize, 24);
+    });
+    CValue setFontSize = paragraph.Get(NSMethods::SetFontSize.GetName());
+    measure(bench, context, "SetFontSize/resolved_function", count, [&]() {
+        setFontSize.Call("call", paragraph, 24);
+    });
+
+    // getter returning a new object
+    measure(bench, context, "GetParaPr/by_name", count, [&]() {
+        paragraph.Call("GetParaPr");
+    });
+    measure(bench, context, "GetParaPr/by_method_id", count, [&]() {
+        paragraph.Call(NSMethods::GetParaPr);
+    });
+    CValue getParaPr = paragraph.Get(NSMethods::GetParaPr.GetName());
+    measure(bench, context, "GetParaPr/resolved_function", count, [&]() {
+        getParaPr.Call("call", paragraph);
+    });
+    bench.Phase("calls");
+
+    measureChartData(bench, context, 10000, 100);
+    bench.Phase("chart_data");
+
+    // Close without saving
+    builder.CloseFile();
+    CDocBuilder::Dispose();
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_BATCH_H
+#define SAMPLES_UTILS_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "docbuilder.h"
+
+// Pushing document content by batches.
+// ApiDocument.Push() adds one element per call, so a document of N paragraphs costs N calls into JS only for pushing.
+// CDocumentBatch keeps created paragraphs and tables on C++ side and pushes all of them at once:
+//   [p1, p2, ..., pN].forEach(document.Push.bind(document))
+// Setting of array elements is much cheaper than a method call, and the bound function is resolved only once.
+// Batch is pushed by Flush() (at the end of every section of the document) or when it reaches its maximum size,
+// which limits the number of JS values kept alive by the batch.
+// The same class works with CRecordedValue from recorder.h, where the batch is recorded into the script.
+namespace NSUtils
+{
+	// JS array of `items`
+	inline NSDoctRenderer::CValue CreateBatchArray(const std::vector<NSDoctRenderer::CValue>& items)
+	{
+		NSDoctRenderer::CValue arr = NSDoctRenderer::CValue::CreateArray((int)items.size());
+		for (size_t i = 0; i < items.size(); i++)
+			arr[(int)i] = items[i];
+		return arr;
+	}
+
+	// method `name` of `object`, bound to it, so it may be called as a callback
+	inline NSDoctRenderer::CValue GetBoundMethod(NSDoctRenderer::CValue object, const char* name)
+	{
+		return object.Get(name).Call("bind", object);
+	}
+
+	template<class TValue>
+	class CDocumentBatch
+	{
+	private:
+		TValue m_document;
+		TValue m_push;
+		std::vector<TValue> m_elements;
+		bool m_enabled;
+		bool m_pushResolved;
+		size_t m_maxSize;
+		size_t m_calls;
+
+	public:
+		// With `enabled` = false every element is pushed at once with its own call (to compare with batches)
+		CDocumentBatch(TValue document, bool enabled = true, size_t maxSize = 1000)
+			: m_document(document), m_enabled(enabled), m_pushResolved(false), m_maxSize(maxSize > 0 ? maxSize : 1), m_calls(0)
+		{
+			if (m_enabled)
+				m_elements.reserve(m_maxSize);
+		}
+
+		void Add(TValue element)
+		{
+			if (!m_enabled)
+			{
+				m_document.Call("Push", element);
+				m_calls++;
+				return;
+			}
+			m_elements.push_back(element);
+			if (m_elements.size() >= m_maxSize)
+				Flush();
+		}
+
+		// pushes all added elements to the document
+		void Flush()
+		{
+			if (m_elements.empty())
+				return;
+			if (m_elements.size() == 1)
+			{
+				m_document.Call("Push", m_elements[0]);
+				m_calls++;
+			}
+			else
+			{
+				if (!m_pushResolved)
+				{
+					m_push = GetBoundMethod(m_document, "Push");
+					m_pushResolved = true;
+					m_calls++;
+				}
+				CreateBatchArray(m_elements).Call("forEach", m_push);
+				m_calls++;
+			}
+			m_elements.clear();
+		}
+
+		// number of JS methods called from C++ for pushing (elements of batch arrays are set without calls)
+		size_t GetCallsCount() const
+		{
+			return m_calls;
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_BATCH_H
@@ -0,0 +1,280 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_BENCH_H
+#define SAMPLES_UTILS_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace NSUtils
+{
+	// Measures wall time of a single operation
+	class CStopwatch
+	{
+	private:
+		std::chrono::steady_clock::time_point m_start;
+
+	public:
+		CStopwatch() : m_start(std::chrono::steady_clock::now())
+		{
+		}
+
+		void Restart()
+		{
+			m_start = std::chrono::steady_clock::now();
+		}
+
+		double GetElapsedMs() const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+		}
+	};
+
+	// Returns current resident set size of the process in KB, or 0 if it is unknown on this platform
+	inline size_t GetResidentMemory()
+	{
+#ifdef __linux__
+		FILE* file = fopen("/proc/self/statm", "r");
+		if (!file)
+			return 0;
+		long size = 0;
+		long resident = 0;
+		int count = fscanf(file, "%ld %ld", &size, &resident);
+		fclose(file);
+		return count == 2 ? (size_t)resident * (size_t)(sysconf(_SC_PAGESIZE) / 1024) : 0;
+#else
+		return 0;
+#endif
+	}
+
+	// Measures phases of a sample run.
+	// Results are reported only if DOCBUILDER_BENCH environment variable is set:
+	//   DOCBUILDER_BENCH=1      - print results to stderr
+	//   DOCBUILDER_BENCH=<path> - append results to the file
+	// Every result is written as one JSON object per line:
+	//   {"sample":"creating_invoice","metric":"build","value":12.345,"unit":"ms"}
+	class CBenchTimer
+	{
+	public:
+		typedef std::chrono::steady_clock clock;
+
+		struct CMetric
+		{
+			std::string name;
+			double value;
+			std::string unit;
+		};
+
+	private:
+		std::string m_sample;
+		clock::time_point m_start;
+		clock::time_point m_last;
+		std::vector<CMetric> m_metrics;
+		bool m_reported;
+
+	public:
+		CBenchTimer(const std::string& sample) : m_sample(sample), m_reported(false)
+		{
+			m_start = m_last = clock::now();
+		}
+
+		~CBenchTimer()
+		{
+			Report();
+		}
+
+		static double ToMs(clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		// restarts measuring of the current phase without recording anything
+		void Skip()
+		{
+			m_last = clock::now();
+		}
+
+		// records time passed since the previous phase (or construction) as phase `name`
+		double Phase(const std::string& name)
+		{
+			clock::time_point now = clock::now();
+			double ms = ToMs(now - m_last);
+			m_last = now;
+			Add(name, ms, "ms");
+			return ms;
+		}
+
+		// records an arbitrary value (counters, sizes, throughput)
+		void Add(const std::string& name, double value, const std::string& unit)
+		{
+			CMetric metric = { name, value, unit };
+			m_metrics.push_back(metric);
+		}
+
+		// records size of the file in bytes, e.g. of the saved document
+		void AddFileSize(const std::string& name, const std::string& path)
+		{
+			FILE* file = fopen(path.c_str(), "rb");
+			if (!file)
+				return;
+			fseek(file, 0, SEEK_END);
+			Add(name, (double)ftell(file), "bytes");
+			fclose(file);
+		}
+
+		// records peak resident set size of the process
+		void AddPeakMemory(const std::string& name)
+		{
+#if defined(__linux__) || defined(__APPLE__)
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) != 0)
+				return;
+#ifdef __APPLE__
+			Add(name, (double)usage.ru_maxrss / 1024, "KB");
+#else
+			Add(name, (double)usage.ru_maxrss, "KB");
+#endif
+#endif
+		}
+
+		double GetTotalMs() const
+		{
+			return ToMs(clock::now() - m_start);
+		}
+
+		const std::vector<CMetric>& GetMetrics() const
+		{
+			return m_metrics;
+		}
+
+		static bool IsEnabled()
+		{
+			return getenv("DOCBUILDER_BENCH") != NULL;
+		}
+
+		void Report()
+		{
+			if (m_reported)
+				return;
+			m_reported = true;
+
+			const char* output = getenv("DOCBUILDER_BENCH");
+			if (!output)
+				return;
+
+			FILE* file = stderr;
+			if (std::string(output) != "1")
+				file = fopen(output, "a");
+			if (!file)
+				return;
+
+			Add("total", GetTotalMs(), "ms");
+			for (size_t i = 0; i < m_metrics.size(); i++)
+			{
+				const CMetric& metric = m_metrics[i];
+				fprintf(file, "{\"sample\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"unit\":\"%s\"}\n",
+						m_sample.c_str(), metric.name.c_str(), metric.value, metric.unit.c_str());
+			}
+
+			if (file != stderr)
+				fclose(file);
+		}
+	};
+
+	// Collects durations of repeated operations (e.g. latency of every generated document)
+	// and reports their percentiles
+	class CLatencyStats
+	{
+	private:
+		std::vector<double> m_values;
+
+	public:
+		void Add(double ms)
+		{
+			m_values.push_back(ms);
+		}
+
+		size_t GetCount() const
+		{
+			return m_values.size();
+		}
+
+		// nearest-rank percentile, `percent` is from 0 to 100
+		double GetPercentile(double percent) const
+		{
+			if (m_values.empty())
+				return 0;
+			std::vector<double> sorted(m_values);
+			std::sort(sorted.begin(), sorted.end());
+			size_t rank = (size_t)(percent / 100.0 * sorted.size() + 0.999999);
+			return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+		}
+
+		// prints p50, p90, p99 and max and adds them to `bench` as "<name> p50", etc.
+		void Report(CBenchTimer& bench, const std::string& name) const
+		{
+			const double percents[] = { 50, 90, 99, 100 };
+			const char* labels[] = { "p50", "p90", "p99", "max" };
+			printf("%-24s %6d samples", name.c_str(), (int)m_values.size());
+			for (int i = 0; i < 4; i++)
+			{
+				double value = GetPercentile(percents[i]);
+				printf("  %s %9.1f ms", labels[i], value);
+				bench.Add(name + " " + labels[i], value, "ms");
+			}
+			printf("\n");
+		}
+
+		// prints counts of values by power-of-two buckets (up to 1 ms, up to 2 ms, up to 4 ms, ...)
+		// and adds them to `bench` as "<name> le_<bound>ms"
+		void ReportHistogram(CBenchTimer& bench, const std::string& name) const
+		{
+			std::vector<size_t> buckets;
+			for (size_t i = 0; i < m_values.size(); i++)
+			{
+				size_t bucket = 0;
+				for (double bound = 1; m_values[i] > bound; bound *= 2)
+					bucket++;
+				if (bucket >= buckets.size())
+					buckets.resize(bucket + 1, 0);
+				buckets[bucket]++;
+			}
+			printf("%s histogram:\n", name.c_str());
+			double bound = 1;
+			for (size_t i = 0; i < buckets.size(); i++, bound *= 2)
+			{
+				if (buckets[i] == 0)
+					continue;
+				printf("  <= %8.0f ms %8d\n", bound, (int)buckets[i]);
+				bench.Add(name + " le_" + std::to_string((long long)bound) + "ms", (double)buckets[i], "jobs");
+			}
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_BENCH_H
@@ -0,0 +1,562 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_DEFLATE_H
+#define SAMPLES_UTILS_DEFLATE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// Deflate compression (RFC 1951) used by PNG images and ZIP archives (office documents)
+namespace NSUtils
+{
+	namespace NSDeflate
+	{
+		static const unsigned short LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const unsigned char LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const unsigned short DistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const unsigned char DistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		// reads compressed data by chunks to `buffer`, returns the number of bytes read (0 at the end of data)
+		typedef std::function<size_t(unsigned char* buffer, size_t size)> CInflateSource;
+
+		// size of chunks read from CInflateSource
+		static const size_t InputChunkSize = 65536;
+
+		class CBitReader
+		{
+		private:
+			const unsigned char* m_data;
+			size_t m_size;
+			size_t m_pos;
+			uint32_t m_buffer;
+			int m_count;
+			CInflateSource m_source;
+			std::vector<unsigned char> m_chunk;
+
+			// reads the next chunk of data from the source
+			bool Fill()
+			{
+				if (!m_source)
+					return false;
+				m_size = m_source(&m_chunk[0], m_chunk.size());
+				m_data = &m_chunk[0];
+				m_pos = 0;
+				return m_size > 0;
+			}
+
+		public:
+			bool error;
+
+			CBitReader(const unsigned char* data, size_t size) : m_data(data), m_size(size), m_pos(0), m_buffer(0), m_count(0), error(false)
+			{
+			}
+
+			CBitReader(const CInflateSource& source, size_t chunkSize = InputChunkSize) : m_data(NULL), m_size(0), m_pos(0), m_buffer(0), m_count(0),
+				m_source(source), m_chunk(std::max<size_t>(chunkSize, 1)), error(false)
+			{
+			}
+
+			// returns next `count` bits without consuming them (missing bits at the end of data are zeros)
+			int Peek(int count)
+			{
+				while (m_count < count && (m_pos < m_size || Fill()))
+				{
+					m_buffer |= (uint32_t)m_data[m_pos++] << m_count;
+					m_count += 8;
+				}
+				return (int)(m_buffer & ((1u << count) - 1));
+			}
+
+			void Consume(int count)
+			{
+				if (count > m_count)
+				{
+					error = true;
+					return;
+				}
+				m_buffer >>= count;
+				m_count -= count;
+			}
+
+			int Bits(int count)
+			{
+				while (m_count < count)
+				{
+					if (m_pos >= m_size && !Fill())
+					{
+						error = true;
+						return 0;
+					}
+					m_buffer |= (uint32_t)m_data[m_pos++] << m_count;
+					m_count += 8;
+				}
+				int value = (int)(m_buffer & ((1u << count) - 1));
+				m_buffer >>= count;
+				m_count -= count;
+				return value;
+			}
+
+			// skips the rest of the current byte, whole bytes loaded ahead by Peek() stay in the buffer
+			void Align()
+			{
+				m_buffer >>= m_count & 7;
+				m_count -= m_count & 7;
+			}
+
+			// appends `count` bytes to `output`, must be called after Align()
+			bool ReadBytes(std::vector<unsigned char>& output, size_t count)
+			{
+				for (; count > 0 && m_count >= 8; count--)
+				{
+					output.push_back((unsigned char)m_buffer);
+					m_buffer >>= 8;
+					m_count -= 8;
+				}
+				while (count > 0)
+				{
+					if (m_pos >= m_size && !Fill())
+						return false;
+					size_t size = std::min(count, m_size - m_pos);
+					output.insert(output.end(), m_data + m_pos, m_data + m_pos + size);
+					m_pos += size;
+					count -= size;
+				}
+				return true;
+			}
+		};
+
+		// Canonical Huffman code. Codes up to FastBits long are decoded with lookup table,
+		// longer ones bit by bit as in zlib's puff.c
+		struct CHuffman
+		{
+			static const int FastBits = 9;
+
+			unsigned short counts[16];
+			unsigned short symbols[288];
+			// symbol << 4 | code length for every FastBits-long bit sequence, 0 for longer codes
+			unsigned short fast[1 << FastBits];
+
+			bool Build(const unsigned char* lengths, int count)
+			{
+				memset(counts, 0, sizeof(counts));
+				for (int i = 0; i < count; i++)
+					counts[lengths[i]]++;
+				int left = 1;
+				for (int i = 1; i < 16; i++)
+				{
+					left <<= 1;
+					left -= counts[i];
+					if (left < 0)
+						return false;
+				}
+				unsigned short offsets[16];
+				offsets[1] = 0;
+				for (int i = 1; i < 15; i++)
+					offsets[i + 1] = offsets[i] + counts[i];
+				for (int i = 0; i < count; i++)
+				{
+					if (lengths[i] != 0)
+						symbols[offsets[lengths[i]]++] = (unsigned short)i;
+				}
+
+				memset(fast, 0, sizeof(fast));
+				int code = 0;
+				int index = 0;
+				for (int len = 1; len <= FastBits; len++)
+				{
+					for (int i = 0; i < counts[len]; i++, code++)
+					{
+						// bits of the code are read starting from the most significant one
+						int reversed = 0;
+						for (int bit = 0; bit < len; bit++)
+							reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+						for (int fill = reversed; fill < (1 << FastBits); fill += 1 << len)
+							fast[fill] = (unsigned short)((symbols[index + i] << 4) | len);
+					}
+					index += counts[len];
+					code <<= 1;
+				}
+				return true;
+			}
+
+			int Decode(CBitReader& reader) const
+			{
+				int entry = fast[reader.Peek(FastBits)];
+				if (entry != 0)
+				{
+					reader.Consume(entry & 15);
+					return reader.error ? -1 : entry >> 4;
+				}
+
+				int code = 0;
+				int first = 0;
+				int index = 0;
+				for (int len = 1; len < 16; len++)
+				{
+					code |= reader.Bits(1);
+					int count = counts[len];
+					if (code - count < first)
+						return symbols[index + (code - first)];
+					index += count;
+					first += count;
+					first <<= 1;
+					code <<= 1;
+				}
+				return -1;
+			}
+		};
+
+		// receives decompressed data by chunks
+		typedef std::function<bool(const unsigned char* data, size_t size)> CInflateSink;
+
+		// size of data kept in the output buffer for back references
+		static const size_t WindowSize = 32768;
+		static const size_t ChunkSize = 1 << 20;
+
+		// passes decompressed data to `sink` keeping the window for back references
+		inline bool FlushOutput(std::vector<unsigned char>& output, const CInflateSink& sink, bool final)
+		{
+			if (!sink || (!final && output.size() < ChunkSize + WindowSize))
+				return true;
+			size_t size = final ? output.size() : output.size() - WindowSize;
+			if (size == 0)
+				return true;
+			if (!sink(&output[0], size))
+				return false;
+			output.erase(output.begin(), output.begin() + size);
+			return true;
+		}
+
+		inline bool InflateBlock(CBitReader& reader, std::vector<unsigned char>& output, const CHuffman& lengthCode, const CHuffman& distCode, const CInflateSink& sink)
+		{
+			while (!reader.error)
+			{
+				if (sink && output.size() >= ChunkSize + WindowSize && !FlushOutput(output, sink, false))
+					return false;
+
+				int symbol = lengthCode.Decode(reader);
+				if (symbol < 0)
+					return false;
+				if (symbol < 256)
+				{
+					output.push_back((unsigned char)symbol);
+					continue;
+				}
+				if (symbol == 256)
+					return true;
+
+				symbol -= 257;
+				if (symbol >= 29)
+					return false;
+				int length = LengthBase[symbol] + reader.Bits(LengthExtra[symbol]);
+				int distSymbol = distCode.Decode(reader);
+				if (distSymbol < 0 || distSymbol >= 30)
+					return false;
+				size_t distance = DistBase[distSymbol] + reader.Bits(DistExtra[distSymbol]);
+				if (distance > output.size())
+					return false;
+				size_t from = output.size() - distance;
+				for (int i = 0; i < length; i++)
+					output.push_back(output[from + i]);
+			}
+			return false;
+		}
+
+		// Decompresses raw deflate stream read by `reader`. If `sink` is set, the data is passed to it by chunks
+		// and only the last chunk is kept in `output`, otherwise all the data is appended to `output`.
+		inline bool InflateRaw(CBitReader& reader, std::vector<unsigned char>& output, const CInflateSink& sink = CInflateSink())
+		{
+			if (sink)
+				output.reserve(ChunkSize + WindowSize + 258);
+
+			int last = 0;
+			while (!last)
+			{
+				last = reader.Bits(1);
+				int type = reader.Bits(2);
+				if (reader.error)
+					return false;
+
+				if (type == 0)
+				{
+					reader.Align();
+					std::vector<unsigned char> header;
+					if (!reader.ReadBytes(header, 4))
+						return false;
+					size_t length = header[0] | (header[1] << 8);
+					if ((size_t)(header[2] | (header[3] << 8)) != (~length & 0xFFFF))
+						return false;
+					if (!reader.ReadBytes(output, length) || !FlushOutput(output, sink, false))
+						return false;
+				}
+				else if (type == 1)
+				{
+					unsigned char lengths[288];
+					memset(lengths, 8, 144);
+					memset(lengths + 144, 9, 112);
+					memset(lengths + 256, 7, 24);
+					memset(lengths + 280, 8, 8);
+					unsigned char distLengths[30];
+					memset(distLengths, 5, 30);
+					CHuffman lengthCode, distCode;
+					lengthCode.Build(lengths, 288);
+					distCode.Build(distLengths, 30);
+					if (!InflateBlock(reader, output, lengthCode, distCode, sink))
+						return false;
+				}
+				else if (type == 2)
+				{
+					static const unsigned char order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+					int lengthsCount = reader.Bits(5) + 257;
+					int distCount = reader.Bits(5) + 1;
+					int codesCount = reader.Bits(4) + 4;
+					if (lengthsCount > 286 || distCount > 30)
+						return false;
+
+					unsigned char lengths[320];
+					memset(lengths, 0, sizeof(lengths));
+					for (int i = 0; i < codesCount; i++)
+						lengths[order[i]] = (unsigned char)reader.Bits(3);
+					CHuffman codeLengthCode;
+					if (!codeLengthCode.Build(lengths, 19))
+						return false;
+
+					int index = 0;
+					while (index < lengthsCount + distCount)
+					{
+						int symbol = codeLengthCode.Decode(reader);
+						if (symbol < 0 || reader.error)
+							return false;
+						if (symbol < 16)
+						{
+							lengths[index++] = (unsigned char)symbol;
+							continue;
+						}
+						unsigned char value = 0;
+						int repeat = 0;
+						if (symbol == 16)
+						{
+							if (index == 0)
+								return false;
+							value = lengths[index - 1];
+							repeat = 3 + reader.Bits(2);
+						}
+						else if (symbol == 17)
+						{
+							repeat = 3 + reader.Bits(3);
+						}
+						else
+						{
+							repeat = 11 + reader.Bits(7);
+						}
+						if (index + repeat > lengthsCount + distCount)
+							return false;
+						while (repeat--)
+							lengths[index++] = value;
+					}
+
+					CHuffman lengthCode, distCode;
+					if (!lengthCode.Build(lengths, lengthsCount) || !distCode.Build(lengths + lengthsCount, distCount))
+						return false;
+					if (!InflateBlock(reader, output, lengthCode, distCode, sink))
+						return false;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			return !reader.error && FlushOutput(output, sink, true);
+		}
+
+		inline bool InflateRaw(const unsigned char* data, size_t size, std::vector<unsigned char>& output, const CInflateSink& sink = CInflateSink())
+		{
+			CBitReader reader(data, size);
+			return InflateRaw(reader, output, sink);
+		}
+
+		// decompresses raw deflate stream read from `source` by chunks, so the compressed data isn't kept in memory
+		inline bool InflateRaw(const CInflateSource& source, std::vector<unsigned char>& output, const CInflateSink& sink = CInflateSink())
+		{
+			CBitReader reader(source);
+			return InflateRaw(reader, output, sink);
+		}
+
+		// decompresses zlib stream
+		inline bool Inflate(const unsigned char* data, size_t size, std::vector<unsigned char>& output)
+		{
+			if (size < 2 || (data[0] & 0x0F) != 8)
+				return false;
+			return InflateRaw(data + 2, size - 2, output);
+		}
+
+		class CBitWriter
+		{
+		private:
+			std::vector<unsigned char>& m_output;
+			uint32_t m_buffer;
+			int m_count;
+
+		public:
+			CBitWriter(std::vector<unsigned char>& output) : m_output(output), m_buffer(0), m_count(0)
+			{
+			}
+
+			void Bits(uint32_t value, int count)
+			{
+				m_buffer |= value << m_count;
+				m_count += count;
+				while (m_count >= 8)
+				{
+					m_output.push_back((unsigned char)m_buffer);
+					m_buffer >>= 8;
+					m_count -= 8;
+				}
+			}
+
+			// Huffman codes are stored starting from the most significant bit
+			void Code(uint32_t code, int count)
+			{
+				uint32_t reversed = 0;
+				for (int i = 0; i < count; i++)
+					reversed |= ((code >> i) & 1) << (count - 1 - i);
+				Bits(reversed, count);
+			}
+
+			void Flush()
+			{
+				if (m_count > 0)
+					m_output.push_back((unsigned char)m_buffer);
+				m_buffer = 0;
+				m_count = 0;
+			}
+		};
+
+		inline void WriteLiteral(CBitWriter& writer, int symbol)
+		{
+			if (symbol < 144)
+				writer.Code(0x30 + symbol, 8);
+			else if (symbol < 256)
+				writer.Code(0x190 + symbol - 144, 9);
+			else if (symbol < 280)
+				writer.Code(symbol - 256, 7);
+			else
+				writer.Code(0xC0 + symbol - 280, 8);
+		}
+
+		inline void WriteMatch(CBitWriter& writer, int length, int distance)
+		{
+			int index = 28;
+			while (LengthBase[index] > length)
+				index--;
+			WriteLiteral(writer, 257 + index);
+			writer.Bits(length - LengthBase[index], LengthExtra[index]);
+
+			index = 29;
+			while (DistBase[index] > distance)
+				index--;
+			writer.Code(index, 5);
+			writer.Bits(distance - DistBase[index], DistExtra[index]);
+		}
+
+		// compresses `data` to zlib stream with fixed Huffman codes and hash chain matching
+		inline void Deflate(const unsigned char* data, size_t size, std::vector<unsigned char>& output)
+		{
+			const int windowSize = 32768;
+			const int hashBits = 15;
+			const int maxChain = 64;
+			const int maxLength = 258;
+
+			output.push_back(0x78);
+			output.push_back(0x01);
+
+			CBitWriter writer(output);
+			writer.Bits(1, 1);
+			writer.Bits(1, 2);
+
+			std::vector<int> head(1 << hashBits, -1);
+			std::vector<int> prev(windowSize, -1);
+			size_t pos = 0;
+			while (pos < size)
+			{
+				int bestLength = 0;
+				int bestDistance = 0;
+				if (pos + 3 <= size)
+				{
+					uint32_t hash = ((data[pos] << 16) | (data[pos + 1] << 8) | data[pos + 2]) * 2654435761u >> (32 - hashBits);
+					int candidate = head[hash];
+					int limit = (int)std::min<size_t>(maxLength, size - pos);
+					for (int chain = 0; candidate >= 0 && (int)pos - candidate <= windowSize && chain < maxChain; chain++)
+					{
+						int length = 0;
+						while (length < limit && data[candidate + length] == data[pos + length])
+							length++;
+						if (length > bestLength)
+						{
+							bestLength = length;
+							bestDistance = (int)pos - candidate;
+							if (length == limit)
+								break;
+						}
+						candidate = prev[candidate % windowSize];
+					}
+					prev[pos % windowSize] = head[hash];
+					head[hash] = (int)pos;
+				}
+
+				if (bestLength < 3)
+				{
+					WriteLiteral(writer, data[pos]);
+					pos++;
+					continue;
+				}
+
+				WriteMatch(writer, bestLength, bestDistance);
+				// insert skipped positions into the hash chains
+				size_t end = pos + bestLength;
+				for (pos++; pos < end; pos++)
+				{
+					if (pos + 3 > size)
+						continue;
+					uint32_t hash = ((data[pos] << 16) | (data[pos + 1] << 8) | data[pos + 2]) * 2654435761u >> (32 - hashBits);
+					prev[pos % windowSize] = head[hash];
+					head[hash] = (int)pos;
+				}
+			}
+			WriteLiteral(writer, 256);
+			writer.Flush();
+
+			uint32_t a = 1, b = 0;
+			for (size_t i = 0; i < size; i++)
+			{
+				a = (a + data[i]) % 65521;
+				b = (b + a) % 65521;
+			}
+			uint32_t adler = (b << 16) | a;
+			for (int shift = 24; shift >= 0; shift -= 8)
+				output.push_back((unsigned char)(adler >> shift));
+		}
+	}
+}
+
+#endif // SAMPLES_UTILS_DEFLATE_H
@@ -0,0 +1,98 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_ENGINE_H
+#define SAMPLES_UTILS_ENGINE_H
+
+#include <cstddef>
+
+#include "docbuilder.h"
+
+// Engine and builder of a sample.
+// A sample run as a separate executable initializes the engine, creates its builder and disposes both
+// when it finishes. docgen runs many samples in one process: it initializes the engine once and makes
+// all samples use one shared builder, then CSampleEngine only returns that builder.
+namespace NSUtils
+{
+	class CSampleEngine
+	{
+	private:
+		NSDoctRenderer::CDocBuilder* m_builder;
+		bool m_owner;
+		bool m_disposed;
+
+		static NSDoctRenderer::CDocBuilder*& SharedBuilder()
+		{
+			static NSDoctRenderer::CDocBuilder* builder = NULL;
+			return builder;
+		}
+
+	public:
+		explicit CSampleEngine(const wchar_t* workDir) : m_builder(NULL), m_owner(SharedBuilder() == NULL), m_disposed(false)
+		{
+			if (m_owner)
+				NSDoctRenderer::CDocBuilder::Initialize(workDir);
+		}
+
+		CSampleEngine(const CSampleEngine&) = delete;
+		CSampleEngine& operator=(const CSampleEngine&) = delete;
+
+		~CSampleEngine()
+		{
+			Dispose();
+		}
+
+		// the builder is created on the first call, so the samples using their own builders don't create it
+		NSDoctRenderer::CDocBuilder& GetBuilder()
+		{
+			if (!m_builder)
+				m_builder = m_owner ? new NSDoctRenderer::CDocBuilder() : SharedBuilder();
+			return *m_builder;
+		}
+
+		// true if the engine was initialized by this object, so it may be disposed and initialized again
+		bool IsOwner() const
+		{
+			return m_owner;
+		}
+
+		// Destroys the builder and disposes the engine, if they are owned. The shared builder is only closed.
+		void Dispose()
+		{
+			if (m_disposed)
+				return;
+			m_disposed = true;
+			if (!m_owner)
+			{
+				if (m_builder)
+					m_builder->CloseFile();
+				return;
+			}
+			delete m_builder;
+			NSDoctRenderer::CDocBuilder::Dispose();
+		}
+
+		// Makes samples use `builder` instead of initializing the engine (NULL restores the default)
+		static void SetSharedBuilder(NSDoctRenderer::CDocBuilder* builder)
+		{
+			SharedBuilder() = builder;
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_ENGINE_H
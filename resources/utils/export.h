@@ -0,0 +1,205 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_EXPORT_H
+#define SAMPLES_UTILS_EXPORT_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "docbuilder.h"
+#include "utils.h"
+#include "bench.h"
+
+#if defined(_LINUX) || defined(_MAC)
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+// Saving one built document in several formats.
+// The first format is saved by the builder itself and is used as a source for the rest of them.
+// On Linux and Mac the rest of formats are converted concurrently: every conversion is made by
+// a helper process, which is the same executable started with `--export-helper` arguments
+// (see HandleExportHelper()). On other platforms all formats are saved one after another.
+namespace NSUtils
+{
+	struct CExportFormat
+	{
+		int type;
+		std::wstring path;
+		std::wstring params;
+	};
+
+	struct CExportResult
+	{
+		std::wstring path;
+		int error;
+		double ms;
+	};
+
+	// parameters for saving a thumbnail of the first page to png file
+	inline std::wstring GetThumbnailParams(int width = 1000, int height = 1000)
+	{
+		return L"<m_oThumbnail><format>4</format><aspect>1</aspect><first>true</first><width>" + std::to_wstring(width) +
+			   L"</width><height>" + std::to_wstring(height) + L"</height></m_oThumbnail>";
+	}
+
+	// Must be called at the start of main(): if the process was started as export helper,
+	// converts the file and exits with the result of SaveFile()
+	inline void HandleExportHelper(int argc, char* argv[], const wchar_t* workDir)
+	{
+		if (argc != 6 || std::string(argv[1]) != "--export-helper")
+			return;
+
+		int type = atoi(argv[2]);
+		std::wstring source = GetStringFromUtf8((const unsigned char*)argv[3], strlen(argv[3]));
+		std::wstring target = GetStringFromUtf8((const unsigned char*)argv[4], strlen(argv[4]));
+		std::wstring params = GetStringFromUtf8((const unsigned char*)argv[5], strlen(argv[5]));
+
+		NSDoctRenderer::CDocBuilder::Initialize(workDir);
+		int error = 1;
+		{
+			NSDoctRenderer::CDocBuilder builder;
+			if (builder.OpenFile(source.c_str(), L"") == 0)
+			{
+				error = builder.SaveFile(type, target.c_str(), params.empty() ? NULL : params.c_str());
+				builder.CloseFile();
+			}
+		}
+		NSDoctRenderer::CDocBuilder::Dispose();
+		exit(error == 0 ? 0 : 1);
+	}
+
+	// Saves opened document of `builder` to all `formats`. Returns result for every format in the same order.
+	inline std::vector<CExportResult> ExportDocument(NSDoctRenderer::CDocBuilder& builder, const std::vector<CExportFormat>& formats, bool concurrent = true)
+	{
+		std::vector<CExportResult> results(formats.size());
+		for (size_t i = 0; i < formats.size(); i++)
+		{
+			results[i].path = formats[i].path;
+			results[i].error = 1;
+			results[i].ms = 0;
+		}
+		if (formats.empty())
+			return results;
+
+		CStopwatch stopwatch;
+		const CExportFormat& source = formats[0];
+		results[0].error = builder.SaveFile(source.type, source.path.c_str(), source.params.empty() ? NULL : source.params.c_str());
+		results[0].ms = stopwatch.GetElapsedMs();
+
+#if defined(_LINUX) || defined(_MAC)
+		if (concurrent && results[0].error == 0)
+		{
+			std::string exePath = U_TO_UTF8(GetProcessPath());
+			std::string sourcePath = U_TO_UTF8(source.path);
+			std::vector<pid_t> pids(formats.size(), -1);
+
+			stopwatch.Restart();
+			for (size_t i = 1; i < formats.size(); i++)
+			{
+				// prepare all arguments before fork(), only exec is made in the child
+				std::string type = std::to_string(formats[i].type);
+				std::string target = U_TO_UTF8(formats[i].path);
+				std::string params = U_TO_UTF8(formats[i].params);
+				const char* args[] = { exePath.c_str(), "--export-helper", type.c_str(), sourcePath.c_str(), target.c_str(), params.c_str(), NULL };
+
+				pid_t pid = fork();
+				if (pid == 0)
+				{
+					execv(args[0], (char* const*)args);
+					_exit(127);
+				}
+				pids[i] = pid;
+			}
+
+			size_t running = 0;
+			for (size_t i = 1; i < formats.size(); i++)
+			{
+				if (pids[i] > 0)
+					running++;
+			}
+			// Only own helpers are waited for: other children of the process (e.g. curl processes of the image cache)
+			// are reaped by their owners. Helpers are polled, so the time of every format is taken when it finishes.
+			std::vector<bool> finished(formats.size(), false);
+			while (running > 0)
+			{
+				size_t wasRunning = running;
+				for (size_t i = 1; i < formats.size(); i++)
+				{
+					if (pids[i] <= 0 || finished[i])
+						continue;
+					int status = 0;
+					pid_t pid = waitpid(pids[i], &status, WNOHANG);
+					if (pid == 0 || (pid < 0 && errno == EINTR))
+						continue;
+					results[i].error = (pid == pids[i] && WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1;
+					results[i].ms = stopwatch.GetElapsedMs();
+					finished[i] = true;
+					running--;
+				}
+				if (running == wasRunning)
+					usleep(1000);
+			}
+
+			// fall back to saving by the builder if helper couldn't be started
+			for (size_t i = 1; i < formats.size(); i++)
+			{
+				if (pids[i] > 0)
+					continue;
+				CStopwatch formatStopwatch;
+				results[i].error = builder.SaveFile(formats[i].type, formats[i].path.c_str(), formats[i].params.empty() ? NULL : formats[i].params.c_str());
+				results[i].ms = formatStopwatch.GetElapsedMs();
+			}
+			return results;
+		}
+#endif
+
+		for (size_t i = 1; i < formats.size(); i++)
+		{
+			stopwatch.Restart();
+			results[i].error = builder.SaveFile(formats[i].type, formats[i].path.c_str(), formats[i].params.empty() ? NULL : formats[i].params.c_str());
+			results[i].ms = stopwatch.GetElapsedMs();
+		}
+		return results;
+	}
+
+	// Prints export results and adds them to `bench`. Returns true if all formats were saved.
+	inline bool ReportExportResults(const std::vector<CExportResult>& results, CBenchTimer& bench)
+	{
+		bool success = true;
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			std::string path = U_TO_UTF8(results[i].path);
+			if (results[i].error != 0)
+			{
+				fprintf(stderr, "Failed to save %s\n", path.c_str());
+				success = false;
+				continue;
+			}
+			printf("Saved %s in %.0f ms\n", path.c_str(), results[i].ms);
+			bench.Add("export " + path, results[i].ms, "ms");
+		}
+		return success;
+	}
+}
+
+#endif // SAMPLES_UTILS_EXPORT_H
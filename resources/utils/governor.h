@@ -0,0 +1,125 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_GOVERNOR_H
+#define SAMPLES_UTILS_GOVERNOR_H
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "docbuilder.h"
+#include "bench.h"
+
+// Recycling of long-lived builders.
+// JS heap and native caches of a builder grow with every CreateFile()/CloseFile() cycle, so a builder which
+// generates documents one after another is replaced with a new one when resident memory of the process
+// (read from /proc/self/statm after every job) or the number of its jobs crosses the limit.
+// If the governor owns the engine (the only builder of the process), the engine is also disposed and
+// initialized again. With several builders (worker threads) only the builder itself is replaced:
+// CDocBuilder::Dispose() is process-wide and can't be called while other builders are working.
+namespace NSUtils
+{
+	struct CRecycleLimits
+	{
+		// recycle when resident memory of the process is above this value after a job (0 - no limit)
+		size_t maxResidentKB;
+		// recycle after this number of jobs (0 - no limit)
+		size_t maxJobs;
+	};
+
+	class CBuilderGovernor
+	{
+	private:
+		CRecycleLimits m_limits;
+		const wchar_t* m_workDir;
+		std::unique_ptr<NSDoctRenderer::CDocBuilder> m_builder;
+		size_t m_jobs;
+		size_t m_recycles;
+		double m_recycleMs;
+		size_t m_maxResidentKB;
+
+	public:
+		// `workDir` is passed only by the owner of the engine: then recycling also calls Dispose() and Initialize()
+		explicit CBuilderGovernor(const CRecycleLimits& limits, const wchar_t* workDir = NULL)
+			: m_limits(limits), m_workDir(workDir), m_builder(new NSDoctRenderer::CDocBuilder()), m_jobs(0), m_recycles(0), m_recycleMs(0), m_maxResidentKB(0)
+		{
+		}
+
+		NSDoctRenderer::CDocBuilder& GetBuilder()
+		{
+			return *m_builder;
+		}
+
+		// Must be called after every job, when the document is closed. Returns true if the builder was recycled.
+		bool AfterJob()
+		{
+			m_jobs++;
+			size_t residentKB = GetResidentMemory();
+			m_maxResidentKB = std::max(m_maxResidentKB, residentKB);
+			bool overMemory = m_limits.maxResidentKB > 0 && residentKB > m_limits.maxResidentKB;
+			bool overJobs = m_limits.maxJobs > 0 && m_jobs >= m_limits.maxJobs;
+			if (!overMemory && !overJobs)
+				return false;
+
+			CStopwatch stopwatch;
+			m_builder.reset();
+			if (m_workDir)
+			{
+				NSDoctRenderer::CDocBuilder::Dispose();
+				NSDoctRenderer::CDocBuilder::Initialize(m_workDir);
+			}
+			m_builder.reset(new NSDoctRenderer::CDocBuilder());
+			double ms = stopwatch.GetElapsedMs();
+
+			fprintf(stderr, "Recycled builder after %d jobs (%s): resident memory %d -> %d KB in %.1f ms\n", (int)m_jobs,
+					overMemory ? "memory limit" : "jobs limit", (int)residentKB, (int)GetResidentMemory(), ms);
+			m_recycles++;
+			m_recycleMs += ms;
+			m_jobs = 0;
+			return true;
+		}
+
+		size_t GetRecyclesCount() const
+		{
+			return m_recycles;
+		}
+
+		double GetRecycleMs() const
+		{
+			return m_recycleMs;
+		}
+
+		// maximum resident memory seen after jobs
+		size_t GetMaxResidentKB() const
+		{
+			return m_maxResidentKB;
+		}
+
+		void Report(CBenchTimer& bench, const std::string& prefix = "") const
+		{
+			bench.Add(prefix + "recycles", (double)m_recycles, "count");
+			bench.Add(prefix + "recycle_time", m_recycleMs, "ms");
+			bench.Add(prefix + "max_resident_after_job", (double)m_maxResidentKB, "KB");
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_GOVERNOR_H
@@ -0,0 +1,245 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_IMAGE_CACHE_H
+#define SAMPLES_UTILS_IMAGE_CACHE_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+#include "bench.h"
+#include "output_cache.h"
+
+#if defined(_LINUX) || defined(_MAC)
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Prefetching of images referenced by URL.
+// All the images are collected before building and downloaded concurrently (by `curl` processes) into the cache,
+// then the samples pass local paths to the builder instead of URLs, so it doesn't download them one by one.
+// The cache is content-addressed: every image is stored once under the hash of its data, and every URL
+// refers to the stored image, so the images downloaded once are used offline by later runs.
+// Cache directory is set with DOCBUILDER_IMAGE_CACHE_DIR environment variable ("image_cache" by default).
+// On Windows, or if an image can't be downloaded, its URL is passed to the builder as is.
+namespace NSUtils
+{
+	class CImagePrefetcher
+	{
+	private:
+		std::string m_dir;
+		std::vector<std::string> m_urls;
+		std::map<std::string, std::string> m_paths;
+		size_t m_maxProcesses;
+
+		static bool IsRemote(const std::string& url)
+		{
+			return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+		}
+
+		static std::string GetExtension(const std::string& url)
+		{
+			std::string path = url.substr(0, url.find_first_of("?#"));
+			size_t slash = path.find_last_of('/');
+			size_t dot = path.find_last_of('.');
+			if (dot == std::string::npos || (slash != std::string::npos && dot < slash) || path.length() - dot > 5)
+				return ".img";
+			return path.substr(dot);
+		}
+
+		std::string GetIndexPath(const std::string& url) const
+		{
+			CHash64 hash;
+			hash.Update(url);
+			return m_dir + "/url_" + hash.GetHex();
+		}
+
+#if defined(_LINUX) || defined(_MAC)
+		// returns path to the cached image for `url` or empty string
+		std::string FindCached(const std::string& url) const
+		{
+			FILE* file = fopen(GetIndexPath(url).c_str(), "r");
+			if (!file)
+				return "";
+			char name[64] = {};
+			bool found = fscanf(file, "%63s", name) == 1;
+			fclose(file);
+			if (!found)
+				return "";
+			std::string path = m_dir + "/" + name;
+			return (access(path.c_str(), R_OK) == 0) ? path : "";
+		}
+
+		// moves downloaded file to its content address and links `url` to it
+		std::string AddToCache(const std::string& url, const std::string& downloadPath) const
+		{
+			CHash64 hash;
+			if (!hash.UpdateFile(downloadPath))
+				return "";
+			std::string name = hash.GetHex() + GetExtension(url);
+			std::string path = m_dir + "/" + name;
+			if (rename(downloadPath.c_str(), path.c_str()) != 0)
+				return "";
+
+			std::string index = GetIndexPath(url);
+			std::string temp = index + ".tmp";
+			FILE* file = fopen(temp.c_str(), "w");
+			if (!file)
+				return "";
+			fprintf(file, "%s\n", name.c_str());
+			fclose(file);
+			rename(temp.c_str(), index.c_str());
+			return path;
+		}
+#endif
+
+	public:
+		CImagePrefetcher() : m_dir("image_cache"), m_maxProcesses(8)
+		{
+			const char* dir = getenv("DOCBUILDER_IMAGE_CACHE_DIR");
+			if (dir && *dir)
+				m_dir = dir;
+#if defined(_LINUX) || defined(_MAC)
+			// the builder needs absolute paths
+			if (m_dir[0] != '/')
+			{
+				char buffer[4096];
+				if (getcwd(buffer, sizeof(buffer)))
+					m_dir = std::string(buffer) + "/" + m_dir;
+			}
+			mkdir(m_dir.c_str(), 0755);
+#endif
+		}
+
+		// adds image to download, local paths are ignored
+		void Add(const std::string& url)
+		{
+			if (IsRemote(url) && m_paths.find(url) == m_paths.end())
+			{
+				m_urls.push_back(url);
+				m_paths[url] = url;
+			}
+		}
+
+		// Downloads all added images which aren't cached yet. Returns the number of images which couldn't be fetched.
+		size_t Fetch(CBenchTimer& bench)
+		{
+			CStopwatch stopwatch;
+			size_t hits = 0;
+			size_t downloads = 0;
+			size_t failures = 0;
+#if defined(_LINUX) || defined(_MAC)
+			std::vector<std::string> missing;
+			for (size_t i = 0; i < m_urls.size(); i++)
+			{
+				std::string path = FindCached(m_urls[i]);
+				if (path.empty())
+				{
+					missing.push_back(m_urls[i]);
+					continue;
+				}
+				m_paths[m_urls[i]] = path;
+				hits++;
+			}
+
+			std::map<pid_t, size_t> running;
+			std::vector<std::string> downloadPaths(missing.size());
+			size_t next = 0;
+			while (next < missing.size() || !running.empty())
+			{
+				while (next < missing.size() && running.size() < m_maxProcesses)
+				{
+					downloadPaths[next] = m_dir + "/download_" + std::to_string(getpid()) + "_" + std::to_string(next);
+					const char* args[] = { "curl", "-sSfL", "--max-time", "60", "-o", downloadPaths[next].c_str(), missing[next].c_str(), NULL };
+					pid_t pid = fork();
+					if (pid == 0)
+					{
+						execvp(args[0], (char* const*)args);
+						_exit(127);
+					}
+					if (pid > 0)
+						running[pid] = next;
+					else
+						failures++;
+					next++;
+				}
+
+				// only own curl processes are waited for, other children of the process are reaped by their owners
+				int status = 0;
+				pid_t pid = 0;
+				std::map<pid_t, size_t>::iterator it = running.begin();
+				for (; it != running.end(); ++it)
+				{
+					pid = waitpid(it->first, &status, WNOHANG);
+					if (pid == it->first || (pid < 0 && errno != EINTR))
+						break;
+				}
+				if (it == running.end())
+				{
+					usleep(1000);
+					continue;
+				}
+				size_t index = it->second;
+				running.erase(it);
+
+				std::string path;
+				if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+					path = AddToCache(missing[index], downloadPaths[index]);
+				if (path.empty())
+				{
+					remove(downloadPaths[index].c_str());
+					fprintf(stderr, "Failed to download %s\n", missing[index].c_str());
+					failures++;
+					continue;
+				}
+				m_paths[missing[index]] = path;
+				downloads++;
+			}
+#else
+			failures = m_urls.size();
+#endif
+			bench.Add("image_prefetch", stopwatch.GetElapsedMs(), "ms");
+			bench.Add("image_cache_hits", (double)hits, "count");
+			bench.Add("image_downloads", (double)downloads, "count");
+			return failures;
+		}
+
+		// returns local path of the image if it was fetched or `url` itself
+		std::string Get(const std::string& url) const
+		{
+			std::map<std::string, std::string>::const_iterator it = m_paths.find(url);
+			return (it != m_paths.end()) ? it->second : url;
+		}
+
+		std::wstring Get(const std::wstring& url) const
+		{
+			std::string path = Get(U_TO_UTF8(url));
+			return GetStringFromUtf8((const unsigned char*)path.c_str(), path.length());
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_IMAGE_CACHE_H
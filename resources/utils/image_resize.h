@@ -0,0 +1,558 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_IMAGE_RESIZE_H
+#define SAMPLES_UTILS_IMAGE_RESIZE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "deflate.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SAMPLES_UTILS_RESIZE_SSE2
+#endif
+
+// Downscaling of images to the size they occupy in the document.
+// Images are often much larger than the slide or form box they are placed into, which makes output files
+// bigger and saving slower. The image is decoded, resampled with area-averaging filter to the pixel size
+// of its box at the given DPI and encoded again before it is passed to the builder.
+// Only non-interlaced 8-bit PNG images are supported, other images are used as is.
+namespace NSUtils
+{
+	// RGBA image with 8 bits per channel
+	struct CImage
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+
+		CImage() : width(0), height(0)
+		{
+		}
+
+		bool HasAlpha() const
+		{
+			for (size_t i = 3; i < pixels.size(); i += 4)
+			{
+				if (pixels[i] != 255)
+					return true;
+			}
+			return false;
+		}
+	};
+
+	namespace NSPng
+	{
+		inline uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+		{
+			static uint32_t table[256];
+			static bool initialized = false;
+			if (!initialized)
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t c = i;
+					for (int k = 0; k < 8; k++)
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					table[i] = c;
+				}
+				initialized = true;
+			}
+			crc = ~crc;
+			for (size_t i = 0; i < size; i++)
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			return ~crc;
+		}
+
+		inline uint32_t ReadUInt32(const unsigned char* data)
+		{
+			return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+		}
+
+		inline void WriteUInt32(std::vector<unsigned char>& output, uint32_t value)
+		{
+			for (int shift = 24; shift >= 0; shift -= 8)
+				output.push_back((unsigned char)(value >> shift));
+		}
+
+		inline void WriteChunk(std::vector<unsigned char>& output, const char* type, const std::vector<unsigned char>& data)
+		{
+			WriteUInt32(output, (uint32_t)data.size());
+			size_t start = output.size();
+			output.insert(output.end(), type, type + 4);
+			output.insert(output.end(), data.begin(), data.end());
+			WriteUInt32(output, Crc32(&output[start], output.size() - start));
+		}
+
+		inline int Paeth(int a, int b, int c)
+		{
+			int p = a + b - c;
+			int pa = abs(p - a);
+			int pb = abs(p - b);
+			int pc = abs(p - c);
+			if (pa <= pb && pa <= pc)
+				return a;
+			return (pb <= pc) ? b : c;
+		}
+
+		static const unsigned char Signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	}
+
+	// Decodes non-interlaced PNG image with 8 bits per channel to RGBA
+	inline bool DecodePng(const std::vector<unsigned char>& data, CImage& image)
+	{
+		if (data.size() < 8 || memcmp(&data[0], NSPng::Signature, 8) != 0)
+			return false;
+
+		int width = 0, height = 0, colorType = -1;
+		std::vector<unsigned char> palette;
+		std::vector<unsigned char> transparency;
+		std::vector<unsigned char> compressed;
+		size_t pos = 8;
+		while (pos + 12 <= data.size())
+		{
+			uint32_t length = NSPng::ReadUInt32(&data[pos]);
+			if (pos + 12 + length > data.size())
+				return false;
+			std::string type((const char*)&data[pos + 4], 4);
+			const unsigned char* chunk = &data[pos + 8];
+			if (type == "IHDR")
+			{
+				if (length < 13)
+					return false;
+				width = (int)NSPng::ReadUInt32(chunk);
+				height = (int)NSPng::ReadUInt32(chunk + 4);
+				colorType = chunk[9];
+				// bit depth, interlace
+				if (chunk[8] != 8 || chunk[12] != 0)
+					return false;
+			}
+			else if (type == "PLTE")
+				palette.assign(chunk, chunk + length);
+			else if (type == "tRNS")
+				transparency.assign(chunk, chunk + length);
+			else if (type == "IDAT")
+				compressed.insert(compressed.end(), chunk, chunk + length);
+			else if (type == "IEND")
+				break;
+			pos += 12 + length;
+		}
+
+		int channels = 0;
+		switch (colorType)
+		{
+		case 0: channels = 1; break;
+		case 2: channels = 3; break;
+		case 3: channels = 1; break;
+		case 4: channels = 2; break;
+		case 6: channels = 4; break;
+		default: return false;
+		}
+		if (width <= 0 || height <= 0 || compressed.empty() || (colorType == 3 && palette.empty()))
+			return false;
+
+		std::vector<unsigned char> raw;
+		size_t stride = (size_t)width * channels;
+		raw.reserve((stride + 1) * height);
+		if (!NSDeflate::Inflate(&compressed[0], compressed.size(), raw) || raw.size() < (stride + 1) * height)
+			return false;
+
+		// undo filters in place
+		for (int y = 0; y < height; y++)
+		{
+			unsigned char* row = &raw[y * (stride + 1) + 1];
+			const unsigned char* prior = (y > 0) ? row - (stride + 1) : NULL;
+			int filter = row[-1];
+			for (size_t x = 0; x < stride; x++)
+			{
+				int a = (x >= (size_t)channels) ? row[x - channels] : 0;
+				int b = prior ? prior[x] : 0;
+				int c = (prior && x >= (size_t)channels) ? prior[x - channels] : 0;
+				switch (filter)
+				{
+				case 0: break;
+				case 1: row[x] = (unsigned char)(row[x] + a); break;
+				case 2: row[x] = (unsigned char)(row[x] + b); break;
+				case 3: row[x] = (unsigned char)(row[x] + ((a + b) >> 1)); break;
+				case 4: row[x] = (unsigned char)(row[x] + NSPng::Paeth(a, b, c)); break;
+				default: return false;
+				}
+			}
+		}
+
+		image.width = width;
+		image.height = height;
+		image.pixels.resize((size_t)width * height * 4);
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = &raw[y * (stride + 1) + 1];
+			unsigned char* out = &image.pixels[(size_t)y * width * 4];
+			for (int x = 0; x < width; x++, out += 4)
+			{
+				const unsigned char* p = row + (size_t)x * channels;
+				switch (colorType)
+				{
+				case 0:
+					out[0] = out[1] = out[2] = p[0];
+					out[3] = 255;
+					break;
+				case 2:
+					out[0] = p[0]; out[1] = p[1]; out[2] = p[2];
+					out[3] = 255;
+					break;
+				case 3:
+					if ((size_t)p[0] * 3 + 2 >= palette.size())
+						return false;
+					out[0] = palette[p[0] * 3]; out[1] = palette[p[0] * 3 + 1]; out[2] = palette[p[0] * 3 + 2];
+					out[3] = (p[0] < transparency.size()) ? transparency[p[0]] : 255;
+					break;
+				case 4:
+					out[0] = out[1] = out[2] = p[0];
+					out[3] = p[1];
+					break;
+				default:
+					memcpy(out, p, 4);
+					break;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Encodes RGBA image to PNG (RGB if the image is opaque)
+	inline void EncodePng(const CImage& image, std::vector<unsigned char>& output)
+	{
+		int channels = image.HasAlpha() ? 4 : 3;
+		size_t stride = (size_t)image.width * channels;
+
+		// choose filter of every row by the minimum sum of absolute differences
+		std::vector<unsigned char> filtered;
+		filtered.reserve((stride + 1) * image.height);
+		std::vector<unsigned char> current(stride), previous(stride, 0), candidate(stride), best(stride);
+		for (int y = 0; y < image.height; y++)
+		{
+			const unsigned char* source = &image.pixels[(size_t)y * image.width * 4];
+			for (int x = 0; x < image.width; x++)
+				memcpy(&current[(size_t)x * channels], source + (size_t)x * 4, channels);
+
+			unsigned long long bestSum = ~0ULL;
+			int bestFilter = 0;
+			for (int filter = 0; filter < 5; filter++)
+			{
+				unsigned long long sum = 0;
+				for (size_t x = 0; x < stride; x++)
+				{
+					int a = (x >= (size_t)channels) ? current[x - channels] : 0;
+					int b = previous[x];
+					int c = (x >= (size_t)channels) ? previous[x - channels] : 0;
+					int predicted = 0;
+					switch (filter)
+					{
+					case 1: predicted = a; break;
+					case 2: predicted = b; break;
+					case 3: predicted = (a + b) >> 1; break;
+					case 4: predicted = NSPng::Paeth(a, b, c); break;
+					}
+					candidate[x] = (unsigned char)(current[x] - predicted);
+					sum += (candidate[x] < 128) ? candidate[x] : 256 - candidate[x];
+				}
+				if (sum < bestSum)
+				{
+					bestSum = sum;
+					bestFilter = filter;
+					best.swap(candidate);
+				}
+			}
+			filtered.push_back((unsigned char)bestFilter);
+			filtered.insert(filtered.end(), best.begin(), best.end());
+			previous.swap(current);
+		}
+
+		output.assign(NSPng::Signature, NSPng::Signature + 8);
+		std::vector<unsigned char> header;
+		NSPng::WriteUInt32(header, (uint32_t)image.width);
+		NSPng::WriteUInt32(header, (uint32_t)image.height);
+		header.push_back(8);
+		header.push_back(channels == 4 ? 6 : 2);
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+		NSPng::WriteChunk(output, "IHDR", header);
+
+		std::vector<unsigned char> compressed;
+		NSDeflate::Deflate(filtered.empty() ? NULL : &filtered[0], filtered.size(), compressed);
+		NSPng::WriteChunk(output, "IDAT", compressed);
+		NSPng::WriteChunk(output, "IEND", std::vector<unsigned char>());
+	}
+
+	namespace NSResize
+	{
+		static const int WeightBits = 14;
+
+		// contribution of source pixels to one destination pixel
+		struct CContribution
+		{
+			int first;
+			std::vector<int> weights;
+		};
+
+		// area-averaging weights for downscaling `source` pixels to `target` pixels
+		inline std::vector<CContribution> GetContributions(int source, int target)
+		{
+			std::vector<CContribution> result(target);
+			double scale = (double)source / target;
+			for (int i = 0; i < target; i++)
+			{
+				double start = i * scale;
+				double end = start + scale;
+				CContribution& contribution = result[i];
+				contribution.first = (int)start;
+				int last = std::min(source - 1, (int)(end - 1e-9));
+
+				int sum = 0;
+				int largest = 0;
+				for (int j = contribution.first; j <= last; j++)
+				{
+					double covered = std::min<double>(end, j + 1) - std::max<double>(start, j);
+					int weight = (int)(covered / scale * (1 << WeightBits) + 0.5);
+					contribution.weights.push_back(weight);
+					sum += weight;
+					if (weight > contribution.weights[largest])
+						largest = (int)contribution.weights.size() - 1;
+				}
+				// make weights sum exactly to one
+				contribution.weights[largest] += (1 << WeightBits) - sum;
+			}
+			return result;
+		}
+
+		// adds `row` multiplied by `weight` to `accumulator`
+		inline void AccumulateRow(uint32_t* accumulator, const unsigned char* row, size_t size, int weight)
+		{
+			size_t i = 0;
+#ifdef SAMPLES_UTILS_RESIZE_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i weights = _mm_set1_epi16((short)weight);
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(row + i));
+				__m128i words[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+				for (int k = 0; k < 2; k++)
+				{
+					// 32-bit products are assembled from low and high halves of 16-bit multiplications
+					__m128i low = _mm_mullo_epi16(words[k], weights);
+					__m128i high = _mm_mulhi_epu16(words[k], weights);
+					__m128i* target = (__m128i*)(accumulator + i + k * 8);
+					_mm_storeu_si128(target, _mm_add_epi32(_mm_loadu_si128(target), _mm_unpacklo_epi16(low, high)));
+					_mm_storeu_si128(target + 1, _mm_add_epi32(_mm_loadu_si128(target + 1), _mm_unpackhi_epi16(low, high)));
+				}
+			}
+#endif
+			for (; i < size; i++)
+				accumulator[i] += (uint32_t)row[i] * weight;
+		}
+
+		inline void PremultiplyAlpha(std::vector<unsigned char>& pixels)
+		{
+			for (size_t i = 0; i < pixels.size(); i += 4)
+			{
+				unsigned int alpha = pixels[i + 3];
+				for (int c = 0; c < 3; c++)
+					pixels[i + c] = (unsigned char)((pixels[i + c] * alpha + 127) / 255);
+			}
+		}
+
+		inline void UnpremultiplyAlpha(std::vector<unsigned char>& pixels)
+		{
+			for (size_t i = 0; i < pixels.size(); i += 4)
+			{
+				unsigned int alpha = pixels[i + 3];
+				if (alpha == 0 || alpha == 255)
+					continue;
+				for (int c = 0; c < 3; c++)
+					pixels[i + c] = (unsigned char)std::min<unsigned int>(255, (pixels[i + c] * 255 + alpha / 2) / alpha);
+			}
+		}
+	}
+
+	// Resamples `source` to `width` x `height` pixels with area-averaging filter (for downscaling)
+	inline void ResizeImage(const CImage& source, CImage& target, int width, int height)
+	{
+		std::vector<NSResize::CContribution> columns = NSResize::GetContributions(source.width, width);
+		std::vector<NSResize::CContribution> rows = NSResize::GetContributions(source.height, height);
+		const int rounding = 1 << (NSResize::WeightBits - 1);
+
+		std::vector<unsigned char> pixels = source.pixels;
+		bool alpha = source.HasAlpha();
+		if (alpha)
+			NSResize::PremultiplyAlpha(pixels);
+
+		// vertical pass goes over all source pixels, so it is done first with SIMD on whole rows
+		size_t sourceStride = (size_t)source.width * 4;
+		std::vector<unsigned char> vertical(sourceStride * height);
+		std::vector<uint32_t> accumulator(sourceStride);
+		for (int y = 0; y < height; y++)
+		{
+			std::fill(accumulator.begin(), accumulator.end(), 0);
+			const NSResize::CContribution& contribution = rows[y];
+			for (size_t k = 0; k < contribution.weights.size(); k++)
+				NSResize::AccumulateRow(&accumulator[0], &pixels[(contribution.first + k) * sourceStride], sourceStride, contribution.weights[k]);
+			unsigned char* out = &vertical[y * sourceStride];
+			for (size_t i = 0; i < sourceStride; i++)
+				out[i] = (unsigned char)((accumulator[i] + rounding) >> NSResize::WeightBits);
+		}
+
+		target.width = width;
+		target.height = height;
+		target.pixels.resize((size_t)width * height * 4);
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = &vertical[y * sourceStride];
+			unsigned char* out = &target.pixels[(size_t)y * width * 4];
+			for (int x = 0; x < width; x++)
+			{
+				const NSResize::CContribution& contribution = columns[x];
+				uint32_t sum[4] = { 0, 0, 0, 0 };
+				const unsigned char* p = row + (size_t)contribution.first * 4;
+				for (size_t k = 0; k < contribution.weights.size(); k++, p += 4)
+				{
+					for (int c = 0; c < 4; c++)
+						sum[c] += (uint32_t)p[c] * contribution.weights[k];
+				}
+				for (int c = 0; c < 4; c++)
+					out[x * 4 + c] = (unsigned char)((sum[c] + rounding) >> NSResize::WeightBits);
+			}
+		}
+
+		if (alpha)
+			NSResize::UnpremultiplyAlpha(target.pixels);
+	}
+
+	// Downscales images to the size of their boxes in the document and collects statistics
+	class CImageDownscaler
+	{
+	private:
+		double m_dpi;
+		double m_ms;
+		unsigned long long m_sourceBytes;
+		unsigned long long m_resultBytes;
+		int m_count;
+
+		static bool ReadFile(const std::string& path, std::vector<unsigned char>& data)
+		{
+			FILE* file = fopen(path.c_str(), "rb");
+			if (!file)
+				return false;
+			fseek(file, 0, SEEK_END);
+			long size = ftell(file);
+			fseek(file, 0, SEEK_SET);
+			data.resize(size > 0 ? (size_t)size : 0);
+			bool result = !data.empty() && fread(&data[0], 1, data.size(), file) == data.size();
+			fclose(file);
+			return result;
+		}
+
+	public:
+		// DPI is taken from DOCBUILDER_IMAGE_DPI environment variable (144 by default)
+		CImageDownscaler() : m_dpi(144), m_ms(0), m_sourceBytes(0), m_resultBytes(0), m_count(0)
+		{
+			const char* dpi = getenv("DOCBUILDER_IMAGE_DPI");
+			if (dpi && atof(dpi) > 0)
+				m_dpi = atof(dpi);
+		}
+
+		// Returns path to copy of the image at `path` downscaled to the box of `widthEmu` x `heightEmu`
+		// or `path` itself if the image is not larger than the box or can't be processed.
+		// With `keepAspect` the image covers the box preserving its proportions, otherwise it's stretched to the box.
+		std::string Downscale(const std::string& path, long long widthEmu, long long heightEmu, bool keepAspect)
+		{
+			CStopwatch stopwatch;
+			int boxWidth = std::max(1, (int)(widthEmu * m_dpi / 914400 + 0.5));
+			int boxHeight = std::max(1, (int)(heightEmu * m_dpi / 914400 + 0.5));
+
+			size_t dot = path.find_last_of('.');
+			size_t slash = path.find_last_of("/\\");
+			std::string base = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? path.substr(0, dot) : path;
+			std::string resultPath = base + "_" + std::to_string(boxWidth) + "x" + std::to_string(boxHeight) + ".png";
+
+			std::vector<unsigned char> data;
+			if (!ReadFile(path, data))
+				return path;
+
+			std::vector<unsigned char> encoded;
+			if (!ReadFile(resultPath, encoded))
+			{
+				CImage image;
+				if (!DecodePng(data, image))
+					return path;
+
+				int width = boxWidth;
+				int height = boxHeight;
+				if (keepAspect)
+				{
+					double scale = std::max((double)boxWidth / image.width, (double)boxHeight / image.height);
+					width = std::max(1, (int)(image.width * scale + 0.5));
+					height = std::max(1, (int)(image.height * scale + 0.5));
+				}
+				if (width >= image.width || height >= image.height)
+					return path;
+
+				CImage resized;
+				ResizeImage(image, resized, width, height);
+				EncodePng(resized, encoded);
+				if (encoded.size() >= data.size())
+					return path;
+
+				FILE* file = fopen(resultPath.c_str(), "wb");
+				if (!file)
+					return path;
+				bool written = fwrite(&encoded[0], 1, encoded.size(), file) == encoded.size();
+				if (fclose(file) != 0 || !written)
+				{
+					remove(resultPath.c_str());
+					return path;
+				}
+			}
+
+			m_ms += stopwatch.GetElapsedMs();
+			m_sourceBytes += data.size();
+			m_resultBytes += encoded.size();
+			m_count++;
+			return resultPath;
+		}
+
+		void Report(CBenchTimer& bench) const
+		{
+			bench.Add("image_downscale", m_ms, "ms");
+			bench.Add("images_downscaled", m_count, "count");
+			bench.Add("image_bytes_source", (double)m_sourceBytes, "bytes");
+			bench.Add("image_bytes_downscaled", (double)m_resultBytes, "bytes");
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_IMAGE_RESIZE_H
@@ -0,0 +1,73 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_JSON_STREAM_H
+#define SAMPLES_UTILS_JSON_STREAM_H
+
+#include <functional>
+#include <istream>
+#include <string>
+
+#include "json/json.hpp"
+
+namespace NSUtils
+{
+	typedef std::function<void(nlohmann::json& item)> JsonItemHandler;
+
+	// Parses JSON object from `input` and passes every element of its top-level array `key`
+	// to `handler` as soon as the element is parsed. Elements are not stored, so memory usage
+	// doesn't depend on the array size. Returns the rest of the object, where `key` is an empty array.
+	// If `handler` is empty, the elements are just skipped.
+	inline nlohmann::json ParseJsonStreamingArray(std::istream& input, const std::string& key, JsonItemHandler handler = JsonItemHandler())
+	{
+		typedef nlohmann::json::parse_event_t event_t;
+		bool isKeyFound = false;
+		bool isInArray = false;
+
+		return nlohmann::json::parse(input, [&](int depth, event_t event, nlohmann::json& parsed) -> bool
+		{
+			if (depth == 1)
+			{
+				if (event == event_t::key)
+				{
+					isKeyFound = (parsed == key);
+				}
+				else if (event == event_t::array_start)
+				{
+					isInArray = isKeyFound;
+				}
+				else if (event == event_t::array_end)
+				{
+					isInArray = false;
+				}
+				return true;
+			}
+
+			// element of the array is fully parsed: handle it and drop it from the result
+			if (depth == 2 && isInArray && (event == event_t::object_end || event == event_t::array_end || event == event_t::value))
+			{
+				if (handler)
+					handler(parsed);
+				return false;
+			}
+			return true;
+		});
+	}
+}
+
+#endif // SAMPLES_UTILS_JSON_STREAM_H
@@ -0,0 +1,331 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_MATRIX_H
+#define SAMPLES_UTILS_MATRIX_H
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "docbuilder.h"
+
+// Two-dimensional data for charts and tables.
+// CMatrix keeps all cells in one row-major buffer. Rows, columns, sub-ranges and transposition
+// are available as strided views without copying the cells.
+// ToValue() converts a view to nested JS arrays at once: cells are serialized to JSON and parsed
+// by a single JSON.parse call, instead of a CValue assignment (C++ to JS call) for every cell.
+namespace NSUtils
+{
+	// Sequence of `size` cells, each `stride` cells apart (a row or a column of a matrix)
+	template<typename T>
+	class CVectorView
+	{
+	private:
+		T* m_data;
+		size_t m_size;
+		size_t m_stride;
+
+	public:
+		CVectorView(T* data, size_t size, size_t stride) : m_data(data), m_size(size), m_stride(stride)
+		{
+		}
+
+		size_t GetSize() const
+		{
+			return m_size;
+		}
+
+		T& operator[](size_t index) const
+		{
+			return m_data[index * m_stride];
+		}
+
+		// cells from `first` to the end
+		CVectorView<T> GetTail(size_t first) const
+		{
+			first = std::min(first, m_size);
+			return CVectorView<T>(m_data + first * m_stride, m_size - first, m_stride);
+		}
+	};
+
+	// Rectangular range of cells of a matrix
+	template<typename T>
+	class CMatrixView
+	{
+	private:
+		T* m_data;
+		size_t m_rows;
+		size_t m_cols;
+		size_t m_rowStride;
+		size_t m_colStride;
+
+	public:
+		CMatrixView(T* data, size_t rows, size_t cols, size_t rowStride, size_t colStride)
+			: m_data(data), m_rows(rows), m_cols(cols), m_rowStride(rowStride), m_colStride(colStride)
+		{
+		}
+
+		size_t GetRows() const
+		{
+			return m_rows;
+		}
+
+		size_t GetCols() const
+		{
+			return m_cols;
+		}
+
+		T& operator()(size_t row, size_t col) const
+		{
+			return m_data[row * m_rowStride + col * m_colStride];
+		}
+
+		CVectorView<T> GetRow(size_t row) const
+		{
+			return CVectorView<T>(m_data + row * m_rowStride, m_cols, m_colStride);
+		}
+
+		CVectorView<T> GetColumn(size_t col) const
+		{
+			return CVectorView<T>(m_data + col * m_colStride, m_rows, m_rowStride);
+		}
+
+		// `rows` x `cols` range starting at (`firstRow`, `firstCol`)
+		CMatrixView<T> GetSubView(size_t firstRow, size_t firstCol, size_t rows, size_t cols) const
+		{
+			firstRow = std::min(firstRow, m_rows);
+			firstCol = std::min(firstCol, m_cols);
+			rows = std::min(rows, m_rows - firstRow);
+			cols = std::min(cols, m_cols - firstCol);
+			return CMatrixView<T>(m_data + firstRow * m_rowStride + firstCol * m_colStride, rows, cols, m_rowStride, m_colStride);
+		}
+
+		// range from (`firstRow`, `firstCol`) to the last row and column
+		CMatrixView<T> GetSubView(size_t firstRow, size_t firstCol) const
+		{
+			return GetSubView(firstRow, firstCol, m_rows, m_cols);
+		}
+
+		// the same cells with rows and columns swapped
+		CMatrixView<T> GetTransposed() const
+		{
+			return CMatrixView<T>(m_data, m_cols, m_rows, m_colStride, m_rowStride);
+		}
+	};
+
+	template<typename T>
+	class CMatrix
+	{
+	private:
+		std::vector<T> m_data;
+		size_t m_rows;
+		size_t m_cols;
+
+	public:
+		CMatrix() : m_rows(0), m_cols(0)
+		{
+		}
+
+		CMatrix(size_t rows, size_t cols, const T& value = T()) : m_data(rows * cols, value), m_rows(rows), m_cols(cols)
+		{
+		}
+
+		size_t GetRows() const
+		{
+			return m_rows;
+		}
+
+		size_t GetCols() const
+		{
+			return m_cols;
+		}
+
+		bool IsEmpty() const
+		{
+			return m_data.empty();
+		}
+
+		T& operator()(size_t row, size_t col)
+		{
+			return m_data[row * m_cols + col];
+		}
+
+		const T& operator()(size_t row, size_t col) const
+		{
+			return m_data[row * m_cols + col];
+		}
+
+		CMatrixView<T> GetView()
+		{
+			return CMatrixView<T>(m_data.data(), m_rows, m_cols, m_cols, 1);
+		}
+
+		CMatrixView<const T> GetView() const
+		{
+			return CMatrixView<const T>(m_data.data(), m_rows, m_cols, m_cols, 1);
+		}
+
+		CVectorView<const T> GetRow(size_t row) const
+		{
+			return GetView().GetRow(row);
+		}
+
+		CVectorView<const T> GetColumn(size_t col) const
+		{
+			return GetView().GetColumn(col);
+		}
+	};
+
+	// Copies `source` into a new matrix, which is contiguous even if `source` is a transposed or a sub-range view.
+	// Cells are copied by square tiles, so both reading and writing stay within a few cache lines
+	// when one of the sides goes across rows.
+	template<typename T>
+	CMatrix<typename std::remove_const<T>::type> CopyMatrix(const CMatrixView<T>& source)
+	{
+		const size_t tileSize = 32;
+		CMatrix<typename std::remove_const<T>::type> result(source.GetRows(), source.GetCols());
+		for (size_t rowTile = 0; rowTile < source.GetRows(); rowTile += tileSize)
+		{
+			size_t rowEnd = std::min(rowTile + tileSize, source.GetRows());
+			for (size_t colTile = 0; colTile < source.GetCols(); colTile += tileSize)
+			{
+				size_t colEnd = std::min(colTile + tileSize, source.GetCols());
+				for (size_t row = rowTile; row < rowEnd; row++)
+				{
+					for (size_t col = colTile; col < colEnd; col++)
+						result(row, col) = source(row, col);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Transposed copy of `matrix`
+	template<typename T>
+	CMatrix<T> Transpose(const CMatrix<T>& matrix)
+	{
+		return CopyMatrix(matrix.GetView().GetTransposed());
+	}
+
+	namespace NSMatrix
+	{
+		inline void AppendJson(std::string& json, const std::string& value)
+		{
+			json += '"';
+			const char* text = value.c_str();
+			const char* end = text + value.length();
+			while (text < end)
+			{
+				// copy characters which don't need escaping at once
+				const char* plain = text;
+				while (plain < end && *plain != '"' && *plain != '\\' && (unsigned char)*plain >= 0x20)
+					plain++;
+				json.append(text, plain);
+				if (plain == end)
+					break;
+
+				unsigned char c = (unsigned char)*plain;
+				if (c == '"' || c == '\\')
+				{
+					json += '\\';
+					json += (char)c;
+				}
+				else
+				{
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+					json += buffer;
+				}
+				text = plain + 1;
+			}
+			json += '"';
+		}
+
+		inline void AppendJson(std::string& json, const char* value)
+		{
+			AppendJson(json, std::string(value));
+		}
+
+		inline void AppendJson(std::string& json, double value)
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%.15g", value);
+			json += buffer;
+		}
+
+		inline void AppendJson(std::string& json, int value)
+		{
+			json += std::to_string(value);
+		}
+
+		inline void AppendJson(std::string& json, bool value)
+		{
+			json += value ? "true" : "false";
+		}
+
+		template<typename T>
+		void AppendJson(std::string& json, const CVectorView<T>& vector)
+		{
+			json += '[';
+			for (size_t i = 0; i < vector.GetSize(); i++)
+			{
+				if (i > 0)
+					json += ',';
+				AppendJson(json, vector[i]);
+			}
+			json += ']';
+		}
+
+		inline NSDoctRenderer::CDocBuilderValue ParseJson(NSDoctRenderer::CDocBuilderContext& context, const std::string& json)
+		{
+			return context.GetGlobal()["JSON"].Call("parse", json.c_str());
+		}
+	}
+
+	// Converts `vector` to JS array with one call
+	template<typename T>
+	NSDoctRenderer::CDocBuilderValue ToValue(NSDoctRenderer::CDocBuilderContext& context, const CVectorView<T>& vector)
+	{
+		std::string json;
+		NSMatrix::AppendJson(json, vector);
+		return NSMatrix::ParseJson(context, json);
+	}
+
+	// Converts `matrix` to JS array of rows with one call: result[row][col] = matrix(row, col)
+	template<typename T>
+	NSDoctRenderer::CDocBuilderValue ToValue(NSDoctRenderer::CDocBuilderContext& context, const CMatrixView<T>& matrix)
+	{
+		std::string json;
+		json.reserve(matrix.GetRows() * matrix.GetCols() * 8 + 2);
+		json += '[';
+		for (size_t row = 0; row < matrix.GetRows(); row++)
+		{
+			if (row > 0)
+				json += ',';
+			NSMatrix::AppendJson(json, matrix.GetRow(row));
+		}
+		json += ']';
+		return NSMatrix::ParseJson(context, json);
+	}
+}
+
+#endif // SAMPLES_UTILS_MATRIX_H
@@ -0,0 +1,233 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_MEMORY_SAVE_H
+#define SAMPLES_UTILS_MEMORY_SAVE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "docbuilder.h"
+#include "utils.h"
+
+#if defined(_LINUX) || defined(_MAC)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _LINUX
+#include <sys/sendfile.h>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Saving documents without leaving files on disk.
+// Document Builder is able to save documents only to files, so the document is saved to a temporary file
+// in memory-backed file system (/dev/shm on Linux), which is read or sent to a descriptor and removed at once.
+// The directory may be overridden with DOCBUILDER_SAVE_TMP_DIR environment variable (e.g. to compare with disk).
+namespace NSUtils
+{
+	inline std::string GetSaveTmpDirectory()
+	{
+		const char* dir = getenv("DOCBUILDER_SAVE_TMP_DIR");
+		if (dir && *dir)
+			return dir;
+#ifdef _LINUX
+		if (access("/dev/shm", W_OK) == 0)
+			return "/dev/shm";
+#endif
+#if defined(_LINUX) || defined(_MAC)
+		const char* tmpDir = getenv("TMPDIR");
+		return (tmpDir && *tmpDir) ? tmpDir : "/tmp";
+#else
+		wchar_t buffer[MAX_PATH + 1];
+		DWORD length = GetTempPathW(MAX_PATH + 1, buffer);
+		std::wstring path(buffer, length);
+		return U_TO_UTF8(path);
+#endif
+	}
+
+	// Makes the builder keep its own intermediate files in the same directory
+	inline void SetSaveTmpDirectory(NSDoctRenderer::CDocBuilder& builder)
+	{
+		std::string dir = GetSaveTmpDirectory();
+		builder.SetTmpFolder(GetStringFromUtf8((const unsigned char*)dir.c_str(), dir.length()).c_str());
+	}
+
+	// Returns path of a new unique empty file in the temporary directory
+	inline std::string CreateSaveTmpFile()
+	{
+#if defined(_LINUX) || defined(_MAC)
+		std::string path = GetSaveTmpDirectory() + "/docbuilder_XXXXXX";
+		std::vector<char> buffer(path.begin(), path.end());
+		buffer.push_back('\0');
+		int fd = mkstemp(&buffer[0]);
+		if (fd < 0)
+			return "";
+		close(fd);
+		return std::string(&buffer[0]);
+#else
+		std::wstring dir = GetStringFromUtf8((const unsigned char*)GetSaveTmpDirectory().c_str(), GetSaveTmpDirectory().length());
+		wchar_t buffer[MAX_PATH + 1];
+		if (GetTempFileNameW(dir.c_str(), L"dbd", 0, buffer) == 0)
+			return "";
+		std::wstring path(buffer);
+		return U_TO_UTF8(path);
+#endif
+	}
+
+	// Saves opened document of `builder` to the temporary file and returns its path, or empty string on error
+	inline std::string SaveFileToTmp(NSDoctRenderer::CDocBuilder& builder, int type, const wchar_t* params)
+	{
+		std::string path = CreateSaveTmpFile();
+		if (path.empty())
+			return "";
+		std::wstring pathW = GetStringFromUtf8((const unsigned char*)path.c_str(), path.length());
+		if (builder.SaveFile(type, pathW.c_str(), params) != 0)
+		{
+			remove(path.c_str());
+			return "";
+		}
+		return path;
+	}
+
+	// Moves the file saved by SaveFileToTmp() to `target`. Temporary directory is usually on another
+	// file system, so if the file can't be renamed, it is copied and removed.
+	inline bool MoveSavedFile(const std::string& path, const std::string& target)
+	{
+		remove(target.c_str());
+		if (rename(path.c_str(), target.c_str()) == 0)
+			return true;
+
+		FILE* source = fopen(path.c_str(), "rb");
+		FILE* destination = source ? fopen(target.c_str(), "wb") : NULL;
+		bool result = source && destination;
+		char chunk[65536];
+		size_t readSize;
+		while (result && (readSize = fread(chunk, 1, sizeof(chunk), source)) > 0)
+			result = fwrite(chunk, 1, readSize, destination) == readSize;
+		if (source)
+			fclose(source);
+		if (destination && fclose(destination) != 0)
+			result = false;
+		remove(path.c_str());
+		return result;
+	}
+
+	// Saves opened document of `builder` to `buffer`
+	inline bool SaveFileToBuffer(NSDoctRenderer::CDocBuilder& builder, int type, std::vector<unsigned char>& buffer, const wchar_t* params = NULL)
+	{
+		std::string path = SaveFileToTmp(builder, type, params);
+		if (path.empty())
+			return false;
+
+		bool result = false;
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file)
+		{
+			fseek(file, 0, SEEK_END);
+			long size = ftell(file);
+			fseek(file, 0, SEEK_SET);
+			buffer.resize(size > 0 ? (size_t)size : 0);
+			result = buffer.empty() || fread(&buffer[0], 1, buffer.size(), file) == buffer.size();
+			fclose(file);
+		}
+		remove(path.c_str());
+		return result;
+	}
+
+#if defined(_LINUX) || defined(_MAC)
+	// Saves opened document of `builder` and writes it to file descriptor `fd` (pipe, socket, opened file)
+	inline bool SaveFileToDescriptor(NSDoctRenderer::CDocBuilder& builder, int type, int fd, const wchar_t* params = NULL)
+	{
+		std::string path = SaveFileToTmp(builder, type, params);
+		if (path.empty())
+			return false;
+
+		int source = open(path.c_str(), O_RDONLY);
+		// the file is not needed anymore: the data stays available while it is opened
+		remove(path.c_str());
+		if (source < 0)
+			return false;
+
+		bool result = true;
+#ifdef _LINUX
+		struct stat info;
+		if (fstat(source, &info) == 0)
+		{
+			off_t offset = 0;
+			while (offset < info.st_size)
+			{
+				ssize_t sent = sendfile(fd, source, &offset, (size_t)(info.st_size - offset));
+				if (sent <= 0)
+					break;
+			}
+			if (offset == info.st_size)
+			{
+				close(source);
+				return true;
+			}
+			// sendfile() is not supported for this descriptor: copy the rest of data
+			lseek(source, offset, SEEK_SET);
+		}
+#endif
+		char chunk[65536];
+		ssize_t readSize;
+		while (result && (readSize = read(source, chunk, sizeof(chunk))) > 0)
+		{
+			ssize_t written = 0;
+			while (written < readSize)
+			{
+				ssize_t count = write(fd, chunk + written, (size_t)(readSize - written));
+				if (count <= 0)
+				{
+					result = false;
+					break;
+				}
+				written += count;
+			}
+		}
+		close(source);
+		return result && readSize == 0;
+	}
+#endif
+
+	// Saves opened document of `builder` and writes it to standard output
+	inline bool SaveFileToStdout(NSDoctRenderer::CDocBuilder& builder, int type, const wchar_t* params = NULL)
+	{
+		fflush(stdout);
+#if defined(_LINUX) || defined(_MAC)
+		return SaveFileToDescriptor(builder, type, STDOUT_FILENO, params);
+#else
+		std::vector<unsigned char> buffer;
+		if (!SaveFileToBuffer(builder, type, buffer, params))
+			return false;
+		_setmode(_fileno(stdout), _O_BINARY);
+		bool result = buffer.empty() || fwrite(&buffer[0], 1, buffer.size(), stdout) == buffer.size();
+		return fflush(stdout) == 0 && result;
+#endif
+	}
+}
+
+#endif // SAMPLES_UTILS_MEMORY_SAVE_H
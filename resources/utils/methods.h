@@ -0,0 +1,74 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_METHODS_H
+#define SAMPLES_UTILS_METHODS_H
+
+namespace NSUtils
+{
+	// Name of JS API method, known at compile time.
+	// Can be passed to CValue::Call() instead of string literal:
+	//   cell.Call(NSMethods::SetValue, "Item");
+	// so misspelled method name fails the build instead of returning undefined at runtime.
+	class CMethodId
+	{
+	private:
+		const char* m_name;
+
+	public:
+		constexpr explicit CMethodId(const char* name) : m_name(name)
+		{
+		}
+
+		constexpr const char* GetName() const
+		{
+			return m_name;
+		}
+
+		constexpr operator const char*() const
+		{
+			return m_name;
+		}
+	};
+
+	// Methods called in hot loops of the samples
+	namespace NSMethods
+	{
+		// documents
+		constexpr CMethodId CreateParagraph("CreateParagraph");
+		constexpr CMethodId Push("Push");
+		constexpr CMethodId AddText("AddText");
+		constexpr CMethodId SetFontSize("SetFontSize");
+		constexpr CMethodId SetBold("SetBold");
+		constexpr CMethodId SetJc("SetJc");
+		constexpr CMethodId GetParaPr("GetParaPr");
+		// tables
+		constexpr CMethodId AddRows("AddRows");
+		constexpr CMethodId GetRow("GetRow");
+		constexpr CMethodId GetCell("GetCell");
+		constexpr CMethodId GetContent("GetContent");
+		constexpr CMethodId GetElement("GetElement");
+		// spreadsheets
+		constexpr CMethodId GetRangeByNumber("GetRangeByNumber");
+		constexpr CMethodId SetValue("SetValue");
+		constexpr CMethodId SetFillColor("SetFillColor");
+		constexpr CMethodId CreateColorFromRGB("CreateColorFromRGB");
+	}
+}
+
+#endif // SAMPLES_UTILS_METHODS_H
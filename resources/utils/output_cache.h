@@ -0,0 +1,376 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_OUTPUT_CACHE_H
+#define SAMPLES_UTILS_OUTPUT_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+#include "bench.h"
+
+#if defined(_LINUX) || defined(_MAC)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+// Cache of generated documents.
+// Key of the document is a hash of the sample name, its executable and all of its input files (data, templates).
+// If the document with the same key was generated before, it is hard-linked to the result path instead of being built.
+// The cache is used only if DOCBUILDER_CACHE_DIR environment variable is set (and only on Linux and Mac OS):
+//   DOCBUILDER_CACHE_DIR=<dir>     - directory with cached documents
+//   DOCBUILDER_CACHE_SIZE_MB=<n>   - size budget, least recently used documents are removed above it (512 by default)
+namespace NSUtils
+{
+	// Streaming variant of MurmurHash64A: fast non-cryptographic hash processing 8 bytes per step.
+	// Bytes which don't fill the 8-byte block are kept until the next Update() call, and the tail and
+	// the total length are mixed in once by GetValue(), so the hash doesn't depend on how data is split.
+	// Unlike MurmurHash64A the length is mixed in at the end, as it isn't known at the start.
+	class CHash64
+	{
+	private:
+		static const uint64_t m_mult = 0xc6a4a7935bd1e995ULL;
+		uint64_t m_hash;
+		uint64_t m_length;
+		unsigned char m_tail[8];
+		size_t m_tailSize;
+
+		static uint64_t Mix(uint64_t k)
+		{
+			k *= m_mult;
+			k ^= k >> 47;
+			return k * m_mult;
+		}
+
+		void AddBlock(const unsigned char* block)
+		{
+			uint64_t k;
+			memcpy(&k, block, 8);
+			m_hash ^= Mix(k);
+			m_hash *= m_mult;
+		}
+
+	public:
+		CHash64(uint64_t seed = 0x9e3779b97f4a7c15ULL) : m_hash(seed), m_length(0), m_tailSize(0)
+		{
+		}
+
+		void Update(const void* data, size_t size)
+		{
+			const unsigned char* bytes = (const unsigned char*)data;
+			m_length += size;
+			if (m_tailSize > 0)
+			{
+				size_t count = std::min(size, 8 - m_tailSize);
+				memcpy(m_tail + m_tailSize, bytes, count);
+				m_tailSize += count;
+				bytes += count;
+				size -= count;
+				if (m_tailSize < 8)
+					return;
+				AddBlock(m_tail);
+				m_tailSize = 0;
+			}
+
+			size_t blocks = size / 8;
+			for (size_t i = 0; i < blocks; i++)
+				AddBlock(bytes + i * 8);
+			m_tailSize = size & 7;
+			memcpy(m_tail, bytes + blocks * 8, m_tailSize);
+		}
+
+		void Update(const std::string& data)
+		{
+			Update(data.c_str(), data.length() + 1);
+		}
+
+		// adds content of the file, returns false if the file can't be read
+		bool UpdateFile(const std::string& path)
+		{
+			FILE* file = fopen(path.c_str(), "rb");
+			if (!file)
+				return false;
+			std::vector<char> buffer(1 << 16);
+			size_t readSize;
+			while ((readSize = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+				Update(&buffer[0], readSize);
+			fclose(file);
+			return true;
+		}
+
+		uint64_t GetValue() const
+		{
+			uint64_t h = m_hash;
+			if (m_tailSize > 0)
+			{
+				uint64_t rest = 0;
+				for (size_t i = 0; i < m_tailSize; i++)
+					rest |= (uint64_t)m_tail[i] << (8 * i);
+				h ^= rest;
+				h *= m_mult;
+			}
+			h ^= m_length * m_mult;
+			h ^= h >> 47;
+			h *= m_mult;
+			h ^= h >> 47;
+			return h;
+		}
+
+		std::string GetHex() const
+		{
+			char buffer[17];
+			snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)GetValue());
+			return buffer;
+		}
+	};
+
+	// Lookups of all the caches of the process (e.g. of all the samples run by docgen)
+	struct COutputCacheStats
+	{
+		int lookups;
+		int hits;
+		double savedMs;
+	};
+
+	class COutputCache
+	{
+	private:
+		std::string m_sample;
+		std::string m_dir;
+		unsigned long long m_budget;
+		CHash64 m_hash;
+		bool m_valid;
+
+		std::string GetEntryPath(const std::string& extension) const
+		{
+			return m_dir + "/" + m_sample + "_" + m_hash.GetHex() + extension;
+		}
+
+#if defined(_LINUX) || defined(_MAC)
+		static bool CopyFile(const std::string& from, const std::string& to)
+		{
+			FILE* source = fopen(from.c_str(), "rb");
+			if (!source)
+				return false;
+			FILE* target = fopen(to.c_str(), "wb");
+			bool result = target != NULL;
+			std::vector<char> buffer(1 << 16);
+			size_t readSize;
+			while (result && (readSize = fread(&buffer[0], 1, buffer.size(), source)) > 0)
+				result = fwrite(&buffer[0], 1, readSize, target) == readSize;
+			fclose(source);
+			if (target && fclose(target) != 0)
+				result = false;
+			return result;
+		}
+
+		// links `from` to `to`, copies the file if they are on different file systems
+		static bool LinkFile(const std::string& from, const std::string& to)
+		{
+			return link(from.c_str(), to.c_str()) == 0 || CopyFile(from, to);
+		}
+
+		// removes least recently used entries while the cache is above the budget
+		void Evict()
+		{
+			struct CEntry
+			{
+				std::string path;
+				time_t time;
+				unsigned long long size;
+			};
+			std::vector<CEntry> entries;
+			unsigned long long total = 0;
+
+			DIR* dir = opendir(m_dir.c_str());
+			if (!dir)
+				return;
+			while (struct dirent* item = readdir(dir))
+			{
+				std::string name = item->d_name;
+				if (name.length() < 4 || name.compare(name.length() - 4, 4, ".out") != 0)
+					continue;
+				CEntry entry;
+				entry.path = m_dir + "/" + name;
+				struct stat info;
+				if (stat(entry.path.c_str(), &info) != 0)
+					continue;
+				entry.time = info.st_mtime;
+				entry.size = (unsigned long long)info.st_size;
+				total += entry.size;
+				entries.push_back(entry);
+			}
+			closedir(dir);
+
+			if (total <= m_budget)
+				return;
+			std::sort(entries.begin(), entries.end(), [](const CEntry& a, const CEntry& b) { return a.time < b.time; });
+			for (size_t i = 0; i < entries.size() && total > m_budget; i++)
+			{
+				std::string base = entries[i].path.substr(0, entries[i].path.length() - 4);
+				remove(entries[i].path.c_str());
+				remove((base + ".ms").c_str());
+				total -= entries[i].size;
+			}
+		}
+#endif
+
+	public:
+		COutputCache(const std::string& sample) : m_sample(sample), m_budget(512ULL << 20), m_valid(true)
+		{
+#if defined(_LINUX) || defined(_MAC)
+			const char* dir = getenv("DOCBUILDER_CACHE_DIR");
+			if (dir && *dir)
+			{
+				m_dir = dir;
+				mkdir(m_dir.c_str(), 0755);
+			}
+			const char* budget = getenv("DOCBUILDER_CACHE_SIZE_MB");
+			if (budget && *budget)
+				m_budget = strtoull(budget, NULL, 10) << 20;
+#endif
+			m_hash.Update(sample);
+			// rebuilding the sample invalidates all of its documents
+			m_valid = m_hash.UpdateFile(U_TO_UTF8(GetProcessPath()));
+		}
+
+		bool IsEnabled() const
+		{
+			return !m_dir.empty() && m_valid;
+		}
+
+		static COutputCacheStats& GetRunStats()
+		{
+			static COutputCacheStats stats = { 0, 0, 0 };
+			return stats;
+		}
+
+		// Prints and reports hit rate and time saved by all lookups of the run
+		// as cache_hit_rate and cache_time_saved_total metrics
+		static void ReportRun(CBenchTimer& bench)
+		{
+			const COutputCacheStats& stats = GetRunStats();
+			if (stats.lookups == 0)
+				return;
+			double hitRate = 100.0 * stats.hits / stats.lookups;
+			printf("Cache: %d of %d documents restored (%.0f%%), saved %.0f ms\n", stats.hits, stats.lookups, hitRate, stats.savedMs);
+			bench.Add("cache_hit_rate", hitRate, "%");
+			bench.Add("cache_time_saved_total", stats.savedMs, "ms");
+		}
+
+		// adds an input file to the key of the document
+		void AddInput(const std::string& path)
+		{
+			m_hash.Update(path);
+			if (!m_hash.UpdateFile(path))
+				m_valid = false;
+		}
+
+		// adds arbitrary data that affects the document (e.g. command line options)
+		void AddData(const std::string& data)
+		{
+			m_hash.Update(data);
+		}
+
+		// Removes result of the previous run, which may be a hard link to the cached document,
+		// so the new document isn't written over the cached one. Must be called before saving without the cache.
+		static void Detach(const std::wstring& resultPath)
+		{
+			std::string result = U_TO_UTF8(resultPath);
+			remove(result.c_str());
+		}
+
+		// Links cached document to `resultPath`. Returns false if there is no such document:
+		// in this case the old result is detached from the cache (see Detach()).
+		bool Restore(const std::wstring& resultPath, CBenchTimer& bench)
+		{
+			Detach(resultPath);
+			if (!IsEnabled())
+				return false;
+#if defined(_LINUX) || defined(_MAC)
+			std::string result = U_TO_UTF8(resultPath);
+			std::string entry = GetEntryPath(".out");
+			CStopwatch stopwatch;
+			COutputCacheStats& stats = GetRunStats();
+			stats.lookups++;
+			if (access(entry.c_str(), R_OK) != 0 || !LinkFile(entry, result))
+			{
+				bench.Add("cache_hit", 0, "count");
+				return false;
+			}
+			// mark the entry as recently used
+			utimes(entry.c_str(), NULL);
+			double restoreMs = stopwatch.GetElapsedMs();
+
+			double buildMs = 0;
+			FILE* file = fopen(GetEntryPath(".ms").c_str(), "r");
+			if (file)
+			{
+				if (fscanf(file, "%lf", &buildMs) != 1)
+					buildMs = 0;
+				fclose(file);
+			}
+			double savedMs = buildMs > restoreMs ? buildMs - restoreMs : 0;
+			printf("Restored %s from cache, saved %.0f ms\n", result.c_str(), savedMs);
+			stats.hits++;
+			stats.savedMs += savedMs;
+			bench.Add("cache_hit", 1, "count");
+			bench.Add("cache_time_saved", savedMs, "ms");
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// Puts generated document to the cache. `buildMs` is time spent on generation, it's reported as saved on hit.
+		void Store(const std::wstring& resultPath, double buildMs)
+		{
+			if (!IsEnabled())
+				return;
+#if defined(_LINUX) || defined(_MAC)
+			std::string entry = GetEntryPath(".out");
+			std::string temp = entry + ".tmp";
+			if (!CopyFile(U_TO_UTF8(resultPath), temp) || rename(temp.c_str(), entry.c_str()) != 0)
+			{
+				remove(temp.c_str());
+				return;
+			}
+			// restored documents are hard links to the entry, so protect it from being changed in place
+			chmod(entry.c_str(), 0444);
+			FILE* file = fopen(GetEntryPath(".ms").c_str(), "w");
+			if (file)
+			{
+				fprintf(file, "%.3f\n", buildMs);
+				fclose(file);
+			}
+			Evict();
+#endif
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_OUTPUT_CACHE_H
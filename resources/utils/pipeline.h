@@ -0,0 +1,199 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_PIPELINE_H
+#define SAMPLES_UTILS_PIPELINE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+
+// Generating a series of documents as a pipeline: load input -> build -> write output.
+// Building runs on the calling thread, which owns the builder. Loading of the next inputs and writing
+// of the previous outputs are blocking file operations, so they run on a small pool of I/O threads
+// and overlap with building instead of stalling the builder.
+namespace NSUtils
+{
+	// Fixed pool of threads for blocking I/O operations
+	class CIoThreadPool
+	{
+	private:
+		std::vector<std::thread> m_threads;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_taskAdded;
+		bool m_stopping;
+
+		void Run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_taskAdded.wait(lock, [this]() { return !m_tasks.empty() || m_stopping; });
+					if (m_tasks.empty())
+						return;
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+	public:
+		explicit CIoThreadPool(size_t threadsCount) : m_stopping(false)
+		{
+			for (size_t i = 0; i < std::max<size_t>(threadsCount, 1); i++)
+				m_threads.push_back(std::thread(&CIoThreadPool::Run, this));
+		}
+
+		// Finishes queued tasks and stops the threads
+		~CIoThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stopping = true;
+			}
+			m_taskAdded.notify_all();
+			for (size_t i = 0; i < m_threads.size(); i++)
+				m_threads[i].join();
+		}
+
+		void Post(const std::function<void()>& task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.push_back(task);
+			}
+			m_taskAdded.notify_one();
+		}
+	};
+
+	template<typename TInput>
+	class CDocumentPipeline
+	{
+	public:
+		// reads input of the document `index`
+		typedef std::function<bool(size_t index, TInput& input)> CLoadStage;
+		// builds and saves the document to a temporary file, returns its path or empty string on error
+		typedef std::function<std::string(size_t index, TInput& input)> CBuildStage;
+		// moves the saved temporary file to its destination
+		typedef std::function<bool(size_t index, const std::string& path)> CWriteStage;
+
+	private:
+		struct CJob
+		{
+			TInput input;
+			bool loaded;
+			bool loadResult;
+			CStopwatch stopwatch;
+		};
+
+		size_t m_ioThreads;
+		size_t m_loadAhead;
+
+	public:
+		// `loadAhead` limits the number of inputs loaded before the builder needs them
+		CDocumentPipeline(size_t ioThreads, size_t loadAhead) : m_ioThreads(ioThreads), m_loadAhead(std::max<size_t>(loadAhead, 1))
+		{
+		}
+
+		// Runs `count` jobs. Adds latency of every successful job (from the start of loading
+		// to the end of writing) to `latency` and returns the number of failed jobs.
+		size_t Run(size_t count, const CLoadStage& load, const CBuildStage& build, const CWriteStage& write, CLatencyStats& latency)
+		{
+			std::vector<std::unique_ptr<CJob>> jobs;
+			for (size_t i = 0; i < count; i++)
+			{
+				jobs.push_back(std::unique_ptr<CJob>(new CJob()));
+				jobs.back()->loaded = false;
+				jobs.back()->loadResult = false;
+			}
+
+			std::mutex mutex;
+			std::condition_variable changed;
+			size_t writesLeft = count;
+			size_t failed = 0;
+			{
+				CIoThreadPool pool(m_ioThreads);
+				std::function<void(size_t)> postLoad = [&](size_t index) {
+					CJob* job = jobs[index].get();
+					job->stopwatch.Restart();
+					pool.Post([&, index, job]() {
+						bool result = load(index, job->input);
+						std::lock_guard<std::mutex> lock(mutex);
+						job->loaded = true;
+						job->loadResult = result;
+						changed.notify_all();
+					});
+				};
+				for (size_t i = 0; i < std::min(m_loadAhead, count); i++)
+					postLoad(i);
+
+				for (size_t i = 0; i < count; i++)
+				{
+					CJob* job = jobs[i].get();
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						changed.wait(lock, [job]() { return job->loaded; });
+					}
+					if (i + m_loadAhead < count)
+						postLoad(i + m_loadAhead);
+
+					std::string path = job->loadResult ? build(i, job->input) : std::string();
+					// input is not needed anymore
+					job->input = TInput();
+					if (path.empty())
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						failed++;
+						writesLeft--;
+						continue;
+					}
+					pool.Post([&, i, job, path]() {
+						bool result = write(i, path);
+						double ms = job->stopwatch.GetElapsedMs();
+						std::lock_guard<std::mutex> lock(mutex);
+						if (result)
+							latency.Add(ms);
+						else
+							failed++;
+						writesLeft--;
+						changed.notify_all();
+					});
+				}
+
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&writesLeft]() { return writesLeft == 0; });
+			}
+			return failed;
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_PIPELINE_H
@@ -0,0 +1,435 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SAMPLES_UTILS_RECORDER_H
+#define SAMPLES_UTILS_RECORDER_H
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "docbuilder.h"
+#include "json/json.hpp"
+
+// Record-and-compile support for samples.
+// Every CValue::Call made through CRecordedValue is executed as usual and, if recording is enabled,
+// is also written down as a JavaScript statement. The recorded statements are compiled into a builder
+// script, where all values taken from input JSON are referenced through `data` variable, e.g.:
+//   var v5 = v4.AddText("Annual Report for " + String(data["year"]));
+// Later the script can be executed with a new JSON bound to `data` by a single CDocBuilder::ExecuteCommand().
+// Loops over JSON arrays are unrolled while recording, so the script is valid only for inputs
+// of the same shape (see GetJsonShape()); for other inputs the sample has to be recorded again.
+namespace NSUtils
+{
+	inline std::string GetJsStringLiteral(const std::string& value)
+	{
+		std::string result = "\"";
+		for (size_t i = 0; i < value.length(); i++)
+		{
+			unsigned char c = (unsigned char)value[i];
+			switch (c)
+			{
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			default:
+				if (c < 0x20)
+				{
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", c);
+					result += buf;
+				}
+				else
+				{
+					result += (char)c;
+				}
+			}
+		}
+		result += "\"";
+		return result;
+	}
+
+	// splits JSON pointer (e.g. "/plans/projects/0/name") into unescaped tokens
+	inline std::vector<std::string> GetJsonPointerTokens(const std::string& pointer)
+	{
+		std::vector<std::string> tokens;
+		size_t pos = 1;
+		while (pos <= pointer.length())
+		{
+			size_t next = pointer.find('/', pos);
+			if (next == std::string::npos)
+				next = pointer.length();
+			std::string token = pointer.substr(pos, next - pos);
+			size_t escape = 0;
+			while ((escape = token.find("~1", escape)) != std::string::npos)
+				token.replace(escape, 2, "/");
+			escape = 0;
+			while ((escape = token.find("~0", escape)) != std::string::npos)
+				token.replace(escape, 2, "~");
+			tokens.push_back(token);
+			pos = next + 1;
+		}
+		return tokens;
+	}
+
+	// returns item of `data` located at JSON `pointer`
+	inline const nlohmann::json& GetJsonItem(const nlohmann::json& data, const std::string& pointer)
+	{
+		const nlohmann::json* item = &data;
+		std::vector<std::string> tokens = GetJsonPointerTokens(pointer);
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			if (item->is_array())
+				item = &item->at(std::stoul(tokens[i]));
+			else
+				item = &item->at(tokens[i]);
+		}
+		return *item;
+	}
+
+	// converts JSON pointer (e.g. "/plans/projects/0/name") to JS expression: data["plans"]["projects"][0]["name"]
+	inline std::string GetJsDataExpression(const std::string& pointer)
+	{
+		std::string result = "data";
+		std::vector<std::string> tokens = GetJsonPointerTokens(pointer);
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			const std::string& token = tokens[i];
+			if (!token.empty() && token.find_first_not_of("0123456789") == std::string::npos)
+				result += "[" + token + "]";
+			else
+				result += "[" + GetJsStringLiteral(token) + "]";
+		}
+		return result;
+	}
+
+	// Returns string describing sizes of all arrays in JSON, e.g. "/achievements:2;/plans/projects:2;"
+	inline std::string GetJsonShape(const nlohmann::json& value, const std::string& pointer = "")
+	{
+		std::string result;
+		if (value.is_array())
+		{
+			result += pointer + ":" + std::to_string(value.size()) + ";";
+			for (size_t i = 0; i < value.size(); i++)
+				result += GetJsonShape(value[i], pointer + "/" + std::to_string(i));
+		}
+		else if (value.is_object())
+		{
+			for (nlohmann::json::const_iterator it = value.begin(); it != value.end(); ++it)
+				result += GetJsonShape(it.value(), pointer + "/" + it.key());
+		}
+		return result;
+	}
+
+	class CRecordedValue;
+
+	// Argument of a recorded call: the value for the current run and its JS expression
+	class CRecordArg
+	{
+	public:
+		enum Type
+		{
+			atNone,
+			atBool,
+			atInt,
+			atDouble,
+			atString,
+			atValue
+		};
+
+		Type type;
+		bool boolValue;
+		int intValue;
+		double doubleValue;
+		std::string stringValue;
+		NSDoctRenderer::CValue value;
+		std::string expr;
+
+	public:
+		CRecordArg() : type(atNone), boolValue(false), intValue(0), doubleValue(0)
+		{
+		}
+		CRecordArg(bool v) : type(atBool), boolValue(v), intValue(0), doubleValue(0), expr(v ? "true" : "false")
+		{
+		}
+		CRecordArg(int v) : type(atInt), boolValue(false), intValue(v), doubleValue(0), expr(std::to_string(v))
+		{
+		}
+		CRecordArg(double v) : type(atDouble), boolValue(false), intValue(0), doubleValue(v)
+		{
+			char buf[32];
+			snprintf(buf, sizeof(buf), "%.17g", v);
+			expr = buf;
+		}
+		CRecordArg(const char* v) : type(atString), boolValue(false), intValue(0), doubleValue(0), stringValue(v), expr(GetJsStringLiteral(v))
+		{
+		}
+		CRecordArg(const std::string& v) : type(atString), boolValue(false), intValue(0), doubleValue(0), stringValue(v), expr(GetJsStringLiteral(v))
+		{
+		}
+		CRecordArg(const CRecordedValue& v);
+
+		// value of `data` at JSON `pointer`
+		static CRecordArg FromData(const nlohmann::json& data, const std::string& pointer)
+		{
+			const nlohmann::json& item = GetJsonItem(data, pointer);
+			CRecordArg arg;
+			if (item.is_string())
+				arg = CRecordArg(item.get<std::string>());
+			else if (item.is_boolean())
+				arg = CRecordArg(item.get<bool>());
+			else if (item.is_number_integer())
+				arg = CRecordArg(item.get<int>());
+			else
+				arg = CRecordArg(item.get<double>());
+			arg.expr = GetJsDataExpression(pointer);
+			return arg;
+		}
+
+		// value of `data` at JSON `pointer`, converted to string
+		static CRecordArg FromDataAsString(const nlohmann::json& data, const std::string& pointer)
+		{
+			const nlohmann::json& item = GetJsonItem(data, pointer);
+			CRecordArg arg(item.is_string() ? item.get<std::string>() : item.dump());
+			arg.expr = "String(" + GetJsDataExpression(pointer) + ")";
+			return arg;
+		}
+
+		bool IsNone() const
+		{
+			return type == atNone;
+		}
+
+		NSDoctRenderer::CValue ToValue() const
+		{
+			switch (type)
+			{
+			case atBool: return NSDoctRenderer::CValue(boolValue);
+			case atInt: return NSDoctRenderer::CValue(intValue);
+			case atDouble: return NSDoctRenderer::CValue(doubleValue);
+			case atString: return NSDoctRenderer::CValue(stringValue.c_str());
+			case atValue: return value;
+			default: return NSDoctRenderer::CValue::CreateUndefined();
+			}
+		}
+	};
+
+	// concatenation of strings, where some of them come from `data`
+	inline CRecordArg operator+(const CRecordArg& left, const CRecordArg& right)
+	{
+		CRecordArg result(left.stringValue + right.stringValue);
+		result.expr = left.expr + " + " + right.expr;
+		return result;
+	}
+
+	class CCallRecorder
+	{
+	private:
+		bool m_recording;
+		size_t m_crossings;
+		int m_varsCount;
+		std::ostringstream m_script;
+
+	public:
+		CCallRecorder(bool recording = false) : m_recording(recording), m_crossings(0), m_varsCount(0)
+		{
+		}
+
+		bool IsRecording() const
+		{
+			return m_recording;
+		}
+
+		// number of C++ -> JS calls made in the current run
+		size_t GetCrossingsCount() const
+		{
+			return m_crossings;
+		}
+
+		void AddCrossings(size_t count = 1)
+		{
+			m_crossings += count;
+		}
+
+		// adds statement `var vN = <expr>;` and returns the name of the variable
+		std::string AddVariable(const std::string& expr)
+		{
+			std::string name = "v" + std::to_string(++m_varsCount);
+			if (m_recording)
+				m_script << "var " << name << " = " << expr << ";\n";
+			return name;
+		}
+
+		// wraps value, which is available in JS under `expr` name (e.g. `Api`)
+		CRecordedValue Wrap(NSDoctRenderer::CValue value, const std::string& expr);
+
+		// creates JS array with given elements
+		CRecordedValue CreateArray(const std::vector<CRecordArg>& items);
+
+		// returns builder script executing all the recorded calls
+		std::string Compile(const std::string& shape) const
+		{
+			std::string script;
+			script += "// shape: " + shape + "\n";
+			script += "(function(data) {\n";
+			script += m_script.str();
+			script += "})(data);\n";
+			return script;
+		}
+
+		bool Save(const std::string& path, const std::string& shape) const
+		{
+			std::ofstream file(path.c_str(), std::ios::binary);
+			if (!file)
+				return false;
+			file << Compile(shape);
+			return (bool)file;
+		}
+	};
+
+	// CValue with the recorded JS expression of it
+	class CRecordedValue
+	{
+	private:
+		NSDoctRenderer::CValue m_value;
+		std::string m_name;
+		CCallRecorder* m_recorder;
+
+	public:
+		CRecordedValue() : m_recorder(NULL)
+		{
+		}
+		CRecordedValue(NSDoctRenderer::CValue value, const std::string& name, CCallRecorder* recorder)
+			: m_value(value), m_name(name), m_recorder(recorder)
+		{
+		}
+
+		NSDoctRenderer::CValue GetValue() const
+		{
+			return m_value;
+		}
+
+		const std::string& GetName() const
+		{
+			return m_name;
+		}
+
+		CCallRecorder* GetRecorder() const
+		{
+			return m_recorder;
+		}
+
+		// property of the value, e.g. a method to be bound with `bind`
+		CRecordedValue Get(const char* name)
+		{
+			NSDoctRenderer::CValue result = m_value.Get(name);
+			m_recorder->AddCrossings();
+			return CRecordedValue(result, m_recorder->AddVariable(m_name + "." + name), m_recorder);
+		}
+
+		CRecordedValue Call(const char* method,
+							const CRecordArg& p1 = CRecordArg(), const CRecordArg& p2 = CRecordArg(), const CRecordArg& p3 = CRecordArg(),
+							const CRecordArg& p4 = CRecordArg(), const CRecordArg& p5 = CRecordArg(), const CRecordArg& p6 = CRecordArg())
+		{
+			const CRecordArg* args[] = { &p1, &p2, &p3, &p4, &p5, &p6 };
+			int argsCount = 0;
+			while (argsCount < 6 && !args[argsCount]->IsNone())
+				argsCount++;
+
+			NSDoctRenderer::CValue result;
+			switch (argsCount)
+			{
+			case 0: result = m_value.Call(method); break;
+			case 1: result = m_value.Call(method, p1.ToValue()); break;
+			case 2: result = m_value.Call(method, p1.ToValue(), p2.ToValue()); break;
+			case 3: result = m_value.Call(method, p1.ToValue(), p2.ToValue(), p3.ToValue()); break;
+			case 4: result = m_value.Call(method, p1.ToValue(), p2.ToValue(), p3.ToValue(), p4.ToValue()); break;
+			case 5: result = m_value.Call(method, p1.ToValue(), p2.ToValue(), p3.ToValue(), p4.ToValue(), p5.ToValue()); break;
+			default: result = m_value.Call(method, p1.ToValue(), p2.ToValue(), p3.ToValue(), p4.ToValue(), p5.ToValue(), p6.ToValue()); break;
+			}
+			m_recorder->AddCrossings();
+
+			std::string expr = m_name + "." + method + "(";
+			for (int i = 0; i < argsCount; i++)
+			{
+				if (i > 0)
+					expr += ", ";
+				expr += args[i]->expr;
+			}
+			expr += ")";
+			return CRecordedValue(result, m_recorder->AddVariable(expr), m_recorder);
+		}
+	};
+
+	inline CRecordArg::CRecordArg(const CRecordedValue& v) : type(atValue), boolValue(false), intValue(0), doubleValue(0), value(v.GetValue()), expr(v.GetName())
+	{
+	}
+
+	inline CRecordedValue CCallRecorder::Wrap(NSDoctRenderer::CValue value, const std::string& expr)
+	{
+		return CRecordedValue(value, AddVariable(expr), this);
+	}
+
+	inline CRecordedValue CCallRecorder::CreateArray(const std::vector<CRecordArg>& items)
+	{
+		NSDoctRenderer::CValue arr = NSDoctRenderer::CValue::CreateArray((int)items.size());
+		std::string expr = "[";
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			arr[(int)i] = items[i].ToValue();
+			if (i > 0)
+				expr += ", ";
+			expr += items[i].expr;
+		}
+		expr += "]";
+		// creating array and setting every element are separate calls into JS
+		AddCrossings(items.size() + 1);
+		return CRecordedValue(arr, AddVariable(expr), this);
+	}
+
+	// CreateBatchArray() and GetBoundMethod() from batch.h for recorded values
+	inline CRecordedValue CreateBatchArray(const std::vector<CRecordedValue>& items)
+	{
+		return items[0].GetRecorder()->CreateArray(std::vector<CRecordArg>(items.begin(), items.end()));
+	}
+
+	inline CRecordedValue GetBoundMethod(CRecordedValue object, const char* name)
+	{
+		return object.Get(name).Call("bind", object);
+	}
+
+	// Reads script saved by CCallRecorder::Save() and checks that it was recorded for input of the same shape
+	inline bool LoadRecordedScript(const std::string& path, const std::string& shape, std::string& script)
+	{
+		std::ifstream file(path.c_str(), std::ios::binary);
+		if (!file)
+			return false;
+		std::ostringstream content;
+		content << file.rdbuf();
+		script = content.str();
+
+		std::string header = "// shape: " + shape + "\n";
+		return script.compare(0, header.length(), header) == 0;
+	}
+}
+
+#endif // SAMPLES_UTILS_RECORDER_H
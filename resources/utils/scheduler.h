@@ -0,0 +1,514 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_SCHEDULER_H
+#define SAMPLES_UTILS_SCHEDULER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "docbuilder.h"
+#include "bench.h"
+#include "governor.h"
+
+// Running document generation jobs on several threads of one process.
+// Every worker thread owns its builder: the JS engine context of CDocBuilder is bound to the thread
+// which created it, so the builder is created, used and destroyed by the worker thread only.
+// Jobs get the builder of the worker which runs them and must not keep CValue objects after return
+// or pass them to other jobs. CDocBuilder::Initialize() and Dispose() are process-wide and have to be
+// called on the main thread before Start() and after Stop().
+//
+// Every worker has its own deque of jobs: the worker takes jobs from the back of it, and when it is empty,
+// steals from the front of the other workers' deques. Jobs are coarse (a whole document), so the deques are
+// guarded by mutexes instead of lock-free structures.
+//
+// CPriorityBuilderQueue is used instead when jobs of different importance share the workers
+// (e.g. interactive requests and nightly batches): jobs are taken by priority with aging,
+// and new jobs are admitted only while the queue and memory are below the limits.
+namespace NSUtils
+{
+	typedef std::function<void(NSDoctRenderer::CDocBuilder& builder)> CBuilderJob;
+
+	struct CWorkerStats
+	{
+		size_t jobs;
+		size_t stolen;
+		double busyMs;
+		size_t recycles;
+		double recycleMs;
+	};
+
+	class CBuilderScheduler
+	{
+	private:
+		struct CWorker
+		{
+			std::mutex mutex;
+			std::deque<CBuilderJob> jobs;
+			std::thread thread;
+			CWorkerStats stats;
+		};
+
+		std::vector<std::unique_ptr<CWorker>> m_workers;
+		CRecycleLimits m_recycle;
+		std::mutex m_mutex;
+		std::condition_variable m_jobAdded;
+		std::condition_variable m_jobsDone;
+		size_t m_queued;
+		size_t m_running;
+		size_t m_nextWorker;
+		bool m_stopping;
+		CStopwatch m_stopwatch;
+		double m_wallMs;
+
+		// index of the worker running on the current thread, or -1 for other threads
+		static int& CurrentWorker()
+		{
+			static thread_local int index = -1;
+			return index;
+		}
+
+		bool PopJob(size_t index, CBuilderJob& job)
+		{
+			CWorker& own = *m_workers[index];
+			{
+				std::lock_guard<std::mutex> lock(own.mutex);
+				if (!own.jobs.empty())
+				{
+					job = std::move(own.jobs.back());
+					own.jobs.pop_back();
+					return true;
+				}
+			}
+			for (size_t i = 1; i < m_workers.size(); i++)
+			{
+				CWorker& victim = *m_workers[(index + i) % m_workers.size()];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.jobs.empty())
+				{
+					job = std::move(victim.jobs.front());
+					victim.jobs.pop_front();
+					own.stats.stolen++;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void Run(size_t index)
+		{
+			CurrentWorker() = (int)index;
+			CWorker& worker = *m_workers[index];
+			CBuilderGovernor governor(m_recycle);
+			while (true)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_jobAdded.wait(lock, [this]() { return m_queued > 0 || m_stopping; });
+					if (m_queued == 0)
+						break;
+					// the job is reserved for this worker, so the deques have it until PopJob() finds it
+					m_queued--;
+					m_running++;
+				}
+
+				CBuilderJob job;
+				while (!PopJob(index, job))
+					std::this_thread::yield();
+
+				CStopwatch stopwatch;
+				job(governor.GetBuilder());
+				worker.stats.busyMs += stopwatch.GetElapsedMs();
+				worker.stats.jobs++;
+				if (governor.AfterJob())
+				{
+					worker.stats.recycles = governor.GetRecyclesCount();
+					worker.stats.recycleMs = governor.GetRecycleMs();
+				}
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running--;
+				if (m_queued == 0 && m_running == 0)
+					m_jobsDone.notify_all();
+			}
+		}
+
+	public:
+		// builders of the workers are replaced when they cross `recycle` limits (see CBuilderGovernor)
+		explicit CBuilderScheduler(size_t threadsCount, const CRecycleLimits& recycle = CRecycleLimits())
+			: m_recycle(recycle), m_queued(0), m_running(0), m_nextWorker(0), m_stopping(false), m_wallMs(0)
+		{
+			for (size_t i = 0; i < std::max<size_t>(threadsCount, 1); i++)
+			{
+				m_workers.push_back(std::unique_ptr<CWorker>(new CWorker()));
+				CWorkerStats& stats = m_workers.back()->stats;
+				stats.jobs = 0;
+				stats.stolen = 0;
+				stats.busyMs = 0;
+				stats.recycles = 0;
+				stats.recycleMs = 0;
+			}
+		}
+
+		~CBuilderScheduler()
+		{
+			Stop();
+		}
+
+		size_t GetThreadsCount() const
+		{
+			return m_workers.size();
+		}
+
+		void Start()
+		{
+			m_stopwatch.Restart();
+			for (size_t i = 0; i < m_workers.size(); i++)
+				m_workers[i]->thread = std::thread(&CBuilderScheduler::Run, this, i);
+		}
+
+		// Adds job to the deque of the current worker if it is called from a job, otherwise spreads jobs between workers
+		void Submit(const CBuilderJob& job)
+		{
+			int current = CurrentWorker();
+			size_t index;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				index = current >= 0 ? (size_t)current : m_nextWorker++ % m_workers.size();
+			}
+			{
+				CWorker& worker = *m_workers[index];
+				std::lock_guard<std::mutex> lock(worker.mutex);
+				worker.jobs.push_back(job);
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_queued++;
+			}
+			m_jobAdded.notify_one();
+		}
+
+		// Waits until all submitted jobs are done
+		void Wait()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobsDone.wait(lock, [this]() { return m_queued == 0 && m_running == 0; });
+			m_wallMs = m_stopwatch.GetElapsedMs();
+		}
+
+		// Waits for submitted jobs and stops workers. Builders of the workers are destroyed on their threads.
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_stopping)
+					return;
+				m_stopping = true;
+			}
+			m_jobAdded.notify_all();
+			for (size_t i = 0; i < m_workers.size(); i++)
+			{
+				if (m_workers[i]->thread.joinable())
+					m_workers[i]->thread.join();
+			}
+			if (m_wallMs == 0)
+				m_wallMs = m_stopwatch.GetElapsedMs();
+		}
+
+		// Statistics of every worker, valid after Wait() or Stop()
+		std::vector<CWorkerStats> GetStats() const
+		{
+			std::vector<CWorkerStats> stats;
+			for (size_t i = 0; i < m_workers.size(); i++)
+				stats.push_back(m_workers[i]->stats);
+			return stats;
+		}
+
+		// Time from Start() to the end of the last Wait()
+		double GetWallMs() const
+		{
+			return m_wallMs;
+		}
+
+		// Prints jobs count and utilization (busy time / wall time) of every worker and adds them to `bench`
+		void Report(CBenchTimer& bench) const
+		{
+			double busyMs = 0;
+			size_t jobs = 0;
+			size_t recycles = 0;
+			double recycleMs = 0;
+			for (size_t i = 0; i < m_workers.size(); i++)
+			{
+				const CWorkerStats& stats = m_workers[i]->stats;
+				double utilization = m_wallMs > 0 ? stats.busyMs * 100.0 / m_wallMs : 0;
+				printf("  worker %2d: %6d jobs (%d stolen), busy %8.0f ms, utilization %5.1f%%, %d recycles in %.0f ms\n", (int)i, (int)stats.jobs,
+					   (int)stats.stolen, stats.busyMs, utilization, (int)stats.recycles, stats.recycleMs);
+				bench.Add("utilization worker " + std::to_string(i), utilization, "%");
+				busyMs += stats.busyMs;
+				jobs += stats.jobs;
+				recycles += stats.recycles;
+				recycleMs += stats.recycleMs;
+			}
+			double utilization = m_wallMs > 0 ? busyMs * 100.0 / (m_wallMs * m_workers.size()) : 0;
+			double throughput = m_wallMs > 0 ? jobs * 1000.0 / m_wallMs : 0;
+			printf("  %d threads: %d jobs in %.0f ms, %.1f jobs/s, utilization %.1f%%\n", (int)m_workers.size(), (int)jobs, m_wallMs, throughput, utilization);
+			std::string suffix = " " + std::to_string(m_workers.size()) + " threads";
+			bench.Add("throughput" + suffix, throughput, "jobs/s");
+			bench.Add("utilization" + suffix, utilization, "%");
+			bench.Add("recycles" + suffix, (double)recycles, "count");
+			bench.Add("recycle_time" + suffix, recycleMs, "ms");
+		}
+	};
+
+	// Limits of CPriorityBuilderQueue
+	struct CQueueLimits
+	{
+		// maximum number of queued jobs of all priorities
+		size_t maxQueued;
+		// number of places in the queue which can be taken only by jobs of the highest priority,
+		// so a batch filling the queue doesn't make interactive requests rejected
+		size_t reserved;
+		// new jobs are not admitted while resident memory of the process is above this value (0 - no limit)
+		size_t maxResidentKB;
+		// waiting for this time raises priority of a job by one level, so low priority jobs are not starved (0 - no aging)
+		double agingMs;
+	};
+
+	// Bounded queue of jobs with several priorities in front of builder workers.
+	// Priority 0 is the highest (e.g. interactive requests), larger numbers are lower (e.g. nightly batches).
+	// Workers own their builders in the same way as in CBuilderScheduler.
+	// Admission control: when the queue is full or memory is above the limit, TrySubmit() rejects the job
+	// at once and Submit() defers it, blocking the caller until the job is admitted.
+	// Time spent in the queue and time of running are collected separately for every priority.
+	class CPriorityBuilderQueue
+	{
+	private:
+		struct CQueuedJob
+		{
+			CBuilderJob job;
+			int priority;
+			CStopwatch queued;
+		};
+
+		struct CPriorityStats
+		{
+			CLatencyStats queueWait;
+			CLatencyStats service;
+			size_t accepted;
+			size_t deferred;
+			size_t rejected;
+		};
+
+		CQueueLimits m_limits;
+		CRecycleLimits m_recycle;
+		std::vector<std::deque<CQueuedJob>> m_queues;
+		std::vector<CPriorityStats> m_stats;
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_jobAdded;
+		std::condition_variable m_jobTaken;
+		size_t m_queued;
+		size_t m_running;
+		bool m_stopping;
+		size_t m_recycles;
+		double m_recycleMs;
+
+		bool IsFull(int priority) const
+		{
+			size_t maxQueued = m_limits.maxQueued;
+			if (priority > 0)
+				maxQueued = m_limits.maxQueued > m_limits.reserved ? m_limits.maxQueued - m_limits.reserved : 1;
+			if (m_queued >= maxQueued)
+				return true;
+			return m_limits.maxResidentKB > 0 && GetResidentMemory() > m_limits.maxResidentKB;
+		}
+
+		// index of the queue whose first job has the highest priority after aging, or -1 if all queues are empty
+		int SelectQueue() const
+		{
+			int selected = -1;
+			double selectedLevel = 0;
+			for (size_t i = 0; i < m_queues.size(); i++)
+			{
+				if (m_queues[i].empty())
+					continue;
+				const CQueuedJob& job = m_queues[i].front();
+				double level = job.priority;
+				if (m_limits.agingMs > 0)
+					level -= job.queued.GetElapsedMs() / m_limits.agingMs;
+				if (selected < 0 || level < selectedLevel)
+				{
+					selected = (int)i;
+					selectedLevel = level;
+				}
+			}
+			return selected;
+		}
+
+		void Run()
+		{
+			CBuilderGovernor governor(m_recycle);
+			while (true)
+			{
+				CQueuedJob job;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_jobAdded.wait(lock, [this]() { return m_queued > 0 || m_stopping; });
+					int index = SelectQueue();
+					if (index < 0)
+						break;
+					job = std::move(m_queues[index].front());
+					m_queues[index].pop_front();
+					m_queued--;
+					m_running++;
+					m_stats[job.priority].queueWait.Add(job.queued.GetElapsedMs());
+				}
+				m_jobTaken.notify_all();
+
+				CStopwatch stopwatch;
+				job.job(governor.GetBuilder());
+				double serviceMs = stopwatch.GetElapsedMs();
+				stopwatch.Restart();
+				bool recycled = governor.AfterJob();
+				double recycleMs = stopwatch.GetElapsedMs();
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stats[job.priority].service.Add(serviceMs);
+					m_running--;
+					if (recycled)
+					{
+						m_recycles++;
+						m_recycleMs += recycleMs;
+					}
+				}
+				// memory may be released by the finished job
+				m_jobTaken.notify_all();
+			}
+		}
+
+		bool Enqueue(int priority, const CBuilderJob& job, bool wait)
+		{
+			priority = std::min(std::max(priority, 0), (int)m_queues.size() - 1);
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				CPriorityStats& stats = m_stats[priority];
+				if (IsFull(priority))
+				{
+					if (!wait)
+					{
+						stats.rejected++;
+						return false;
+					}
+					stats.deferred++;
+					// memory limit is checked again when a job is taken or finished
+					m_jobTaken.wait(lock, [this, priority]() { return !IsFull(priority) || (m_queued == 0 && m_running == 0); });
+				}
+				CQueuedJob queuedJob;
+				queuedJob.job = job;
+				queuedJob.priority = priority;
+				m_queues[priority].push_back(std::move(queuedJob));
+				m_queued++;
+				stats.accepted++;
+			}
+			m_jobAdded.notify_one();
+			return true;
+		}
+
+	public:
+		// builders of the workers are replaced when they cross `recycle` limits (see CBuilderGovernor)
+		CPriorityBuilderQueue(size_t threadsCount, size_t prioritiesCount, const CQueueLimits& limits, const CRecycleLimits& recycle = CRecycleLimits())
+			: m_limits(limits), m_recycle(recycle), m_queues(std::max<size_t>(prioritiesCount, 1)), m_stats(m_queues.size()), m_queued(0), m_running(0),
+			  m_stopping(false), m_recycles(0), m_recycleMs(0)
+		{
+			m_limits.maxQueued = std::max<size_t>(m_limits.maxQueued, 1);
+			for (size_t i = 0; i < m_stats.size(); i++)
+			{
+				m_stats[i].accepted = 0;
+				m_stats[i].deferred = 0;
+				m_stats[i].rejected = 0;
+			}
+			for (size_t i = 0; i < std::max<size_t>(threadsCount, 1); i++)
+				m_threads.push_back(std::thread(&CPriorityBuilderQueue::Run, this));
+		}
+
+		~CPriorityBuilderQueue()
+		{
+			Stop();
+		}
+
+		// Adds job if it is admitted, returns false if it is rejected
+		bool TrySubmit(int priority, const CBuilderJob& job)
+		{
+			return Enqueue(priority, job, false);
+		}
+
+		// Adds job, waiting until it is admitted
+		void Submit(int priority, const CBuilderJob& job)
+		{
+			Enqueue(priority, job, true);
+		}
+
+		// Runs all queued jobs and stops workers
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_stopping)
+					return;
+				m_stopping = true;
+			}
+			m_jobAdded.notify_all();
+			for (size_t i = 0; i < m_threads.size(); i++)
+				m_threads[i].join();
+		}
+
+		// Prints admission counters and histograms of queue wait and service time for every priority,
+		// `names` are names of the priorities used in the output and metrics. Valid after Stop().
+		void Report(CBenchTimer& bench, const std::vector<std::string>& names) const
+		{
+			for (size_t i = 0; i < m_stats.size(); i++)
+			{
+				const CPriorityStats& stats = m_stats[i];
+				std::string name = i < names.size() ? names[i] : "priority " + std::to_string(i);
+				printf("%s: %d accepted (%d deferred), %d rejected\n", name.c_str(), (int)stats.accepted, (int)stats.deferred, (int)stats.rejected);
+				bench.Add(name + " accepted", (double)stats.accepted, "jobs");
+				bench.Add(name + " deferred", (double)stats.deferred, "jobs");
+				bench.Add(name + " rejected", (double)stats.rejected, "jobs");
+				stats.queueWait.Report(bench, name + " queue_wait");
+				stats.service.Report(bench, name + " service");
+				stats.queueWait.ReportHistogram(bench, name + " queue_wait");
+				stats.service.ReportHistogram(bench, name + " service");
+			}
+			printf("%d builders recycled in %.0f ms\n", (int)m_recycles, m_recycleMs);
+			bench.Add("recycles", (double)m_recycles, "count");
+			bench.Add("recycle_time", m_recycleMs, "ms");
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_SCHEDULER_H
@@ -16,6 +16,9 @@
  *
  */
 
+#ifndef SAMPLES_UTILS_H
+#define SAMPLES_UTILS_H
+
 // convenient macro definitions
 #if defined(__linux__) || defined(__linux)
 #define _LINUX
@@ -423,3 +426,5 @@ namespace NSUtils
 		return path;
 	}
 }
+
+#endif // SAMPLES_UTILS_H
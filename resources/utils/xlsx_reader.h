@@ -0,0 +1,790 @@
+/**
+ *
+ * (c) Copyright Ascensio System SIA 2025
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SAMPLES_UTILS_XLSX_READER_H
+#define SAMPLES_UTILS_XLSX_READER_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "deflate.h"
+#include "matrix.h"
+
+// Reading values of XLSX worksheets without the spreadsheet editor.
+// The workbook is read as ZIP archive, sharedStrings.xml and the worksheet XML are read from the file and
+// decompressed by chunks and parsed while decompressing, so neither the whole compressed entry nor its XML
+// is kept in memory. Only cell values are read
+// (cached results for formulas), formatting is ignored: numbers are returned as they are stored in the file.
+namespace NSUtils
+{
+	// Entries of ZIP archive
+	class CZipReader
+	{
+	private:
+		struct CEntry
+		{
+			std::string name;
+			int method;
+			size_t compressedSize;
+			size_t size;
+			size_t offset;
+		};
+
+		FILE* m_file;
+		std::vector<CEntry> m_entries;
+
+		static unsigned int ReadUInt16(const unsigned char* data)
+		{
+			return data[0] | (data[1] << 8);
+		}
+
+		static unsigned int ReadUInt32(const unsigned char* data)
+		{
+			return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+		}
+
+		const CEntry* Find(const std::string& name) const
+		{
+			for (size_t i = 0; i < m_entries.size(); i++)
+			{
+				if (m_entries[i].name == name)
+					return &m_entries[i];
+			}
+			return NULL;
+		}
+
+	public:
+		CZipReader() : m_file(NULL)
+		{
+		}
+
+		~CZipReader()
+		{
+			if (m_file)
+				fclose(m_file);
+		}
+
+		// reads the central directory of the archive
+		bool Open(const std::string& path)
+		{
+			m_file = fopen(path.c_str(), "rb");
+			if (!m_file)
+				return false;
+
+			// end of central directory is in the last 64 KB (its comment is not longer)
+			fseek(m_file, 0, SEEK_END);
+			long fileSize = ftell(m_file);
+			long tailSize = std::min<long>(fileSize, 65535 + 22);
+			std::vector<unsigned char> tail(tailSize);
+			fseek(m_file, fileSize - tailSize, SEEK_SET);
+			if (tailSize < 22 || fread(&tail[0], 1, tailSize, m_file) != (size_t)tailSize)
+				return false;
+			long end = tailSize - 22;
+			while (end >= 0 && ReadUInt32(&tail[end]) != 0x06054b50)
+				end--;
+			if (end < 0)
+				return false;
+
+			size_t count = ReadUInt16(&tail[end + 10]);
+			size_t directorySize = ReadUInt32(&tail[end + 12]);
+			size_t directoryOffset = ReadUInt32(&tail[end + 16]);
+			std::vector<unsigned char> directory(directorySize);
+			fseek(m_file, (long)directoryOffset, SEEK_SET);
+			if (directorySize == 0 || fread(&directory[0], 1, directorySize, m_file) != directorySize)
+				return false;
+
+			size_t pos = 0;
+			for (size_t i = 0; i < count && pos + 46 <= directorySize; i++)
+			{
+				const unsigned char* header = &directory[pos];
+				if (ReadUInt32(header) != 0x02014b50)
+					return false;
+				CEntry entry;
+				entry.method = ReadUInt16(header + 10);
+				entry.compressedSize = ReadUInt32(header + 20);
+				entry.size = ReadUInt32(header + 24);
+				entry.offset = ReadUInt32(header + 42);
+				size_t nameLength = ReadUInt16(header + 28);
+				size_t extraLength = ReadUInt16(header + 30);
+				size_t commentLength = ReadUInt16(header + 32);
+				if (pos + 46 + nameLength > directorySize)
+					return false;
+				entry.name.assign((const char*)header + 46, nameLength);
+				m_entries.push_back(entry);
+				pos += 46 + nameLength + extraLength + commentLength;
+			}
+			return true;
+		}
+
+		bool Contains(const std::string& name) const
+		{
+			return Find(name) != NULL;
+		}
+
+		// passes decompressed entry to `sink` by chunks
+		bool Read(const std::string& name, const NSDeflate::CInflateSink& sink)
+		{
+			const CEntry* entry = Find(name);
+			if (!entry || !m_file)
+				return false;
+
+			unsigned char header[30];
+			fseek(m_file, (long)entry->offset, SEEK_SET);
+			if (fread(header, 1, 30, m_file) != 30 || ReadUInt32(header) != 0x04034b50)
+				return false;
+			fseek(m_file, (long)(entry->offset + 30 + ReadUInt16(header + 26) + ReadUInt16(header + 28)), SEEK_SET);
+
+			// compressed data is read by chunks of fixed size, not as a whole
+			FILE* file = m_file;
+			size_t left = entry->compressedSize;
+			NSDeflate::CInflateSource source = [file, &left](unsigned char* buffer, size_t size) {
+				size_t count = fread(buffer, 1, std::min(size, left), file);
+				left -= count;
+				return count;
+			};
+
+			if (entry->method == 0)
+			{
+				std::vector<unsigned char> chunk(NSDeflate::InputChunkSize);
+				size_t count;
+				while ((count = source(&chunk[0], chunk.size())) > 0)
+				{
+					if (!sink(&chunk[0], count))
+						return false;
+				}
+				return left == 0;
+			}
+			if (entry->method != 8)
+				return false;
+			std::vector<unsigned char> buffer;
+			return NSDeflate::InflateRaw(source, buffer, sink);
+		}
+
+		// reads the whole entry, is used for small parts of documents
+		bool Read(const std::string& name, std::string& content)
+		{
+			content.clear();
+			return Read(name, [&content](const unsigned char* data, size_t size) {
+				content.append((const char*)data, size);
+				return true;
+			});
+		}
+	};
+
+	// Incremental XML tokenizer: data is added by chunks, complete tags and texts are passed to the handler.
+	// Handler is called as handler(isTag, token) where token is the text or tag without angle brackets.
+	template<typename Handler>
+	class CXmlScanner
+	{
+	private:
+		std::string m_buffer;
+		Handler& m_handler;
+
+		// returns position of '>' closing the tag, which may be inside quoted attribute values
+		size_t FindTagEnd(size_t pos) const
+		{
+			// comments may contain quotes
+			if (m_buffer.compare(pos, 3, "!--") == 0)
+			{
+				size_t end = m_buffer.find("-->", pos + 3);
+				return (end == std::string::npos) ? end : end + 2;
+			}
+			while (true)
+			{
+				pos = m_buffer.find_first_of(">\"'", pos);
+				if (pos == std::string::npos || m_buffer[pos] == '>')
+					return pos;
+				pos = m_buffer.find(m_buffer[pos], pos + 1);
+				if (pos == std::string::npos)
+					return pos;
+				pos++;
+			}
+		}
+
+	public:
+		CXmlScanner(Handler& handler) : m_handler(handler)
+		{
+		}
+
+		void Add(const char* data, size_t size)
+		{
+			m_buffer.append(data, size);
+			size_t pos = 0;
+			size_t length = m_buffer.length();
+			while (pos < length)
+			{
+				if (m_buffer[pos] == '<')
+				{
+					size_t end = FindTagEnd(pos + 1);
+					if (end == std::string::npos)
+						break;
+					m_handler(true, m_buffer.data() + pos + 1, end - pos - 1);
+					pos = end + 1;
+				}
+				else
+				{
+					size_t end = m_buffer.find('<', pos);
+					if (end == std::string::npos)
+						break;
+					m_handler(false, m_buffer.data() + pos, end - pos);
+					pos = end;
+				}
+			}
+			m_buffer.erase(0, pos);
+		}
+	};
+
+	namespace NSXml
+	{
+		// returns true if tag `token` has name `name` ("c", "/c", etc.)
+		inline bool IsTag(const char* token, size_t size, const char* name)
+		{
+			size_t length = strlen(name);
+			if (size < length || memcmp(token, name, length) != 0)
+				return false;
+			return size == length || token[length] == ' ' || token[length] == '/' || token[length] == '\t' || token[length] == '\r' || token[length] == '\n';
+		}
+
+		inline bool IsSelfClosing(const char* token, size_t size)
+		{
+			return size > 0 && token[size - 1] == '/';
+		}
+
+		// returns value of attribute `name` of the tag
+		inline std::string GetAttribute(const char* token, size_t size, const char* name)
+		{
+			size_t length = strlen(name);
+			for (size_t i = 1; i + length + 2 < size; i++)
+			{
+				if ((token[i - 1] == ' ' || token[i - 1] == '\t' || token[i - 1] == '\n' || token[i - 1] == '\r') && memcmp(token + i, name, length) == 0 && token[i + length] == '=')
+				{
+					char quote = token[i + length + 1];
+					const char* start = token + i + length + 2;
+					const char* end = (const char*)memchr(start, quote, size - (start - token));
+					if (end)
+						return std::string(start, end - start);
+				}
+			}
+			return "";
+		}
+
+		// Rounds decimal number to 15 significant digits as "%.15g" does, but without conversion to double.
+		// Numbers in exponential notation or too small or large for fixed notation are formatted with snprintf().
+		inline void RoundNumber(std::string& value)
+		{
+			size_t start = (value[0] == '-') ? 1 : 0;
+			size_t point = value.find('.');
+			bool plain = value.find_first_not_of("0123456789.", start) == std::string::npos && point != std::string::npos;
+			size_t first = value.find_first_not_of("0.", start);
+			if (!plain || first == std::string::npos || first > start + 4 || point - start > 15)
+			{
+				char* end = NULL;
+				double number = strtod(value.c_str(), &end);
+				if (end && *end == '\0')
+				{
+					char buffer[32];
+					snprintf(buffer, sizeof(buffer), "%.15g", number);
+					value = buffer;
+				}
+				return;
+			}
+
+			// find the position of the 16th significant digit
+			size_t pos = first;
+			int digits = 0;
+			while (pos < value.length() && digits < 15)
+			{
+				if (value[pos] != '.')
+					digits++;
+				pos++;
+			}
+			if (pos < value.length() && value[pos] == '.')
+				pos++;
+			if (pos >= value.length())
+				return;
+			if (value[pos] == '5' && pos + 1 == value.length())
+			{
+				// a tie in decimal notation, the binary value decides the direction of rounding
+				char buffer[32];
+				snprintf(buffer, sizeof(buffer), "%.15g", strtod(value.c_str(), NULL));
+				value = buffer;
+				return;
+			}
+
+			bool roundUp = value[pos] >= '5';
+			value.resize(pos);
+			for (size_t i = pos; roundUp && i-- > start;)
+			{
+				if (value[i] == '.')
+					continue;
+				if (value[i] == '9')
+				{
+					value[i] = '0';
+					continue;
+				}
+				value[i]++;
+				roundUp = false;
+			}
+			if (roundUp)
+				value.insert(start, 1, '1');
+
+			// the rest of digits are in the fractional part, remove trailing zeros
+			size_t last = value.find_last_not_of('0');
+			if (value[last] == '.')
+				last--;
+			value.resize(last + 1);
+			if (value == "-0")
+				value = "0";
+		}
+
+		inline void AppendCodepoint(std::string& output, unsigned int code)
+		{
+			if (code < 0x80)
+			{
+				output += (char)code;
+			}
+			else if (code < 0x800)
+			{
+				output += (char)(0xC0 | (code >> 6));
+				output += (char)(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000)
+			{
+				output += (char)(0xE0 | (code >> 12));
+				output += (char)(0x80 | ((code >> 6) & 0x3F));
+				output += (char)(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				output += (char)(0xF0 | (code >> 18));
+				output += (char)(0x80 | ((code >> 12) & 0x3F));
+				output += (char)(0x80 | ((code >> 6) & 0x3F));
+				output += (char)(0x80 | (code & 0x3F));
+			}
+		}
+
+		// appends text with decoded entities to `output`
+		inline void AppendText(std::string& output, const char* text, size_t size)
+		{
+			const char* end = text + size;
+			while (text < end)
+			{
+				const char* amp = (const char*)memchr(text, '&', end - text);
+				if (!amp)
+				{
+					output.append(text, end - text);
+					return;
+				}
+				output.append(text, amp - text);
+				const char* semicolon = (const char*)memchr(amp, ';', end - amp);
+				if (!semicolon)
+				{
+					output.append(amp, end - amp);
+					return;
+				}
+				std::string entity(amp + 1, semicolon - amp - 1);
+				if (entity == "amp")
+					output += '&';
+				else if (entity == "lt")
+					output += '<';
+				else if (entity == "gt")
+					output += '>';
+				else if (entity == "quot")
+					output += '"';
+				else if (entity == "apos")
+					output += '\'';
+				else if (entity.length() > 1 && entity[0] == '#')
+					AppendCodepoint(output, (unsigned int)((entity[1] == 'x') ? strtoul(entity.c_str() + 2, NULL, 16) : strtoul(entity.c_str() + 1, NULL, 10)));
+				else
+					output.append(amp, semicolon + 1 - amp);
+				text = semicolon + 1;
+			}
+		}
+	}
+
+	// Values of the used range of a worksheet
+	typedef CMatrix<std::string> CXlsxRange;
+
+	class CXlsxReader
+	{
+	private:
+		CZipReader m_zip;
+		std::vector<std::string> m_sharedStrings;
+		std::string m_sheetPath;
+		size_t m_cellsCount;
+		size_t m_firstRow;
+		size_t m_firstCol;
+
+		// collects strings of sharedStrings.xml
+		struct CSharedStringsHandler
+		{
+			std::vector<std::string>& strings;
+			bool inText;
+			bool inPhonetic;
+
+			void operator()(bool isTag, const char* token, size_t size)
+			{
+				if (!isTag)
+				{
+					if (inText && !inPhonetic)
+						NSXml::AppendText(strings.back(), token, size);
+					return;
+				}
+				if (NSXml::IsTag(token, size, "si"))
+					strings.push_back("");
+				else if (NSXml::IsTag(token, size, "t") && !NSXml::IsSelfClosing(token, size))
+					inText = !strings.empty();
+				else if (NSXml::IsTag(token, size, "/t"))
+					inText = false;
+				else if (NSXml::IsTag(token, size, "rPh") && !NSXml::IsSelfClosing(token, size))
+					inPhonetic = true;
+				else if (NSXml::IsTag(token, size, "/rPh"))
+					inPhonetic = false;
+			}
+		};
+
+		// collects cell values of the worksheet XML
+		struct CSheetHandler
+		{
+			// the largest <dimension> of the sheet allocated at once
+			static const size_t MaxDimensionCells = 1 << 24;
+
+			const std::vector<std::string>& sharedStrings;
+			// cells within <dimension> of the sheet are written to the matrix allocated when it is read
+			CXlsxRange dimension;
+			size_t dimensionRow;
+			size_t dimensionCol;
+			// non-empty cells outside of the dimension (or all of them, if it is not set) by absolute indexes,
+			// rows are resized on demand
+			std::vector<std::vector<std::string>> cells;
+			size_t cellsCount;
+			int firstRow;
+			int lastRow;
+			int firstCol;
+			int lastCol;
+			int row;
+			int col;
+			std::string type;
+			std::string value;
+			bool inValue;
+			// text of inline string is in <is><t> or <is><r><t>, phonetic runs <rPh> are skipped
+			bool inInlineString;
+			bool inPhonetic;
+
+			CSheetHandler(const std::vector<std::string>& strings) : sharedStrings(strings), dimensionRow(0), dimensionCol(0), cellsCount(0), firstRow(-1), lastRow(-1), firstCol(-1), lastCol(-1), row(-1), col(-1), inValue(false), inInlineString(false), inPhonetic(false)
+			{
+			}
+
+			// parses cell reference like "AB12" to zero-based indexes
+			static bool ParseReference(const std::string& reference, int& row, int& col)
+			{
+				size_t i = 0;
+				int column = 0;
+				while (i < reference.length() && reference[i] >= 'A' && reference[i] <= 'Z')
+					column = column * 26 + (reference[i++] - 'A' + 1);
+				if (column == 0 || i == reference.length())
+					return false;
+				col = column - 1;
+				row = atoi(reference.c_str() + i) - 1;
+				return true;
+			}
+
+			// allocates the matrix for `reference` like "A1:J100"
+			void SetDimension(const std::string& reference)
+			{
+				size_t colon = reference.find(':');
+				int top, left, bottom, right;
+				if (colon == std::string::npos || !ParseReference(reference.substr(0, colon), top, left) || !ParseReference(reference.substr(colon + 1), bottom, right))
+					return;
+				if (top < 0 || left < 0 || bottom < top || right < left)
+					return;
+				size_t rows = (size_t)(bottom - top + 1);
+				size_t cols = (size_t)(right - left + 1);
+				if (rows > MaxDimensionCells / cols)
+					return;
+				dimension = CXlsxRange(rows, cols);
+				dimensionRow = (size_t)top;
+				dimensionCol = (size_t)left;
+			}
+
+			// moves cells of the dimension to `cells`, if some cells are outside of it
+			void MoveDimensionToCells()
+			{
+				for (size_t i = 0; i < dimension.GetRows(); i++)
+				{
+					for (size_t j = 0; j < dimension.GetCols(); j++)
+					{
+						std::string& value = dimension(i, j);
+						if (value.empty())
+							continue;
+						std::vector<std::string>& cellsRow = GetCellsRow(dimensionRow + i, dimensionCol + j);
+						cellsRow[dimensionCol + j].swap(value);
+					}
+				}
+				dimension = CXlsxRange();
+			}
+
+			std::vector<std::string>& GetCellsRow(size_t cellRow, size_t cellCol)
+			{
+				if (cellRow >= cells.size())
+					cells.resize(cellRow + 1);
+				std::vector<std::string>& cellsRow = cells[cellRow];
+				if (cellCol >= cellsRow.size())
+					cellsRow.resize(cellCol + 1);
+				return cellsRow;
+			}
+
+			void EndCell()
+			{
+				if (type == "s")
+				{
+					size_t index = (size_t)atol(value.c_str());
+					value = (index < sharedStrings.size()) ? sharedStrings[index] : "";
+				}
+				else if (type == "b")
+				{
+					value = (value == "1") ? "TRUE" : "FALSE";
+				}
+				else if (type == "inlineStr")
+				{
+					// the text of <is> is already collected to the value
+				}
+				else if ((type.empty() || type == "n") && value.length() > 15)
+				{
+					// numbers are stored with full precision, return them as the editor shows them in General format
+					NSXml::RoundNumber(value);
+				}
+				if (value.empty() || row < 0 || col < 0)
+					return;
+				size_t dimensionI = (size_t)row - dimensionRow;
+				size_t dimensionJ = (size_t)col - dimensionCol;
+				if ((size_t)row >= dimensionRow && (size_t)col >= dimensionCol && dimensionI < dimension.GetRows() && dimensionJ < dimension.GetCols())
+					dimension(dimensionI, dimensionJ).swap(value);
+				else
+					GetCellsRow(row, col)[col].swap(value);
+				firstRow = (firstRow < 0) ? row : std::min(firstRow, row);
+				lastRow = std::max(lastRow, row);
+				firstCol = (firstCol < 0) ? col : std::min(firstCol, col);
+				lastCol = std::max(lastCol, col);
+				cellsCount++;
+			}
+
+			void operator()(bool isTag, const char* token, size_t size)
+			{
+				if (!isTag)
+				{
+					if (inValue)
+						NSXml::AppendText(value, token, size);
+					return;
+				}
+				if (NSXml::IsTag(token, size, "c"))
+				{
+					std::string reference = NSXml::GetAttribute(token, size, "r");
+					if (reference.empty() || !ParseReference(reference, row, col))
+						col++;
+					type = NSXml::GetAttribute(token, size, "t");
+					value.clear();
+					if (NSXml::IsSelfClosing(token, size))
+						EndCell();
+				}
+				else if (NSXml::IsTag(token, size, "/c"))
+				{
+					EndCell();
+				}
+				else if (NSXml::IsTag(token, size, "dimension"))
+				{
+					SetDimension(NSXml::GetAttribute(token, size, "ref"));
+				}
+				else if (NSXml::IsTag(token, size, "row"))
+				{
+					std::string number = NSXml::GetAttribute(token, size, "r");
+					row = number.empty() ? row + 1 : atoi(number.c_str()) - 1;
+					col = -1;
+				}
+				else if (NSXml::IsTag(token, size, "v") && !NSXml::IsSelfClosing(token, size))
+				{
+					inValue = true;
+				}
+				else if (NSXml::IsTag(token, size, "t") && !NSXml::IsSelfClosing(token, size))
+				{
+					inValue = inInlineString && !inPhonetic;
+				}
+				else if (NSXml::IsTag(token, size, "/v") || NSXml::IsTag(token, size, "/t"))
+				{
+					inValue = false;
+				}
+				else if (NSXml::IsTag(token, size, "is") && !NSXml::IsSelfClosing(token, size))
+				{
+					inInlineString = true;
+				}
+				else if (NSXml::IsTag(token, size, "/is"))
+				{
+					inInlineString = false;
+				}
+				else if (NSXml::IsTag(token, size, "rPh") && !NSXml::IsSelfClosing(token, size))
+				{
+					inPhonetic = true;
+				}
+				else if (NSXml::IsTag(token, size, "/rPh"))
+				{
+					inPhonetic = false;
+				}
+			}
+		};
+
+		// finds the path of the active worksheet in the archive
+		std::string FindActiveSheet()
+		{
+			std::string workbook, relations;
+			if (!m_zip.Read("xl/workbook.xml", workbook) || !m_zip.Read("xl/_rels/workbook.xml.rels", relations))
+				return "xl/worksheets/sheet1.xml";
+
+			size_t pos = workbook.find("<workbookView");
+			int activeTab = 0;
+			if (pos != std::string::npos)
+			{
+				size_t end = workbook.find('>', pos);
+				activeTab = atoi(NSXml::GetAttribute(workbook.c_str() + pos + 1, end - pos - 1, "activeTab").c_str());
+			}
+
+			std::string id;
+			pos = 0;
+			for (int i = 0; i <= activeTab; i++)
+			{
+				pos = workbook.find("<sheet ", pos);
+				if (pos == std::string::npos)
+					return "xl/worksheets/sheet1.xml";
+				size_t end = workbook.find('>', pos);
+				id = NSXml::GetAttribute(workbook.c_str() + pos + 1, end - pos - 1, "r:id");
+				pos = end;
+			}
+
+			pos = relations.find("Id=\"" + id + "\"");
+			if (id.empty() || pos == std::string::npos)
+				return "xl/worksheets/sheet1.xml";
+			size_t start = relations.rfind('<', pos);
+			size_t end = relations.find('>', pos);
+			std::string target = NSXml::GetAttribute(relations.c_str() + start + 1, end - start - 1, "Target");
+			if (!target.empty() && target[0] == '/')
+				return target.substr(1);
+			return "xl/" + target;
+		}
+
+	public:
+		CXlsxReader() : m_cellsCount(0), m_firstRow(0), m_firstCol(0)
+		{
+		}
+
+		bool Open(const std::string& path)
+		{
+			if (!m_zip.Open(path))
+				return false;
+			m_sheetPath = FindActiveSheet();
+			if (!m_zip.Contains("xl/sharedStrings.xml"))
+				return true;
+
+			CSharedStringsHandler handler = { m_sharedStrings, false, false };
+			CXmlScanner<CSharedStringsHandler> scanner(handler);
+			return m_zip.Read("xl/sharedStrings.xml", [&scanner](const unsigned char* data, size_t size) {
+				scanner.Add((const char*)data, size);
+				return true;
+			});
+		}
+
+		// Reads the used range of the active worksheet: from the first to the last non-empty row and column
+		bool GetUsedRange(CXlsxRange& range)
+		{
+			CSheetHandler handler(m_sharedStrings);
+			CXmlScanner<CSheetHandler> scanner(handler);
+			bool result = m_zip.Read(m_sheetPath, [&scanner](const unsigned char* data, size_t size) {
+				scanner.Add((const char*)data, size);
+				return true;
+			});
+			range = CXlsxRange();
+			m_cellsCount = handler.cellsCount;
+			m_firstRow = 0;
+			m_firstCol = 0;
+			if (!result || handler.cellsCount == 0)
+				return result;
+
+			// cut the empty rows and columns around the used range
+			size_t firstRow = (size_t)handler.firstRow;
+			size_t firstCol = (size_t)handler.firstCol;
+			size_t height = handler.lastRow - handler.firstRow + 1;
+			size_t width = handler.lastCol - handler.firstCol + 1;
+			m_firstRow = firstRow;
+			m_firstCol = firstCol;
+			if (!handler.cells.empty())
+				handler.MoveDimensionToCells();
+			CXlsxRange& dimension = handler.dimension;
+			if (!dimension.IsEmpty())
+			{
+				// all the cells are within the dimension, which is usually the used range itself
+				size_t top = firstRow - handler.dimensionRow;
+				size_t left = firstCol - handler.dimensionCol;
+				if (top == 0 && left == 0 && height == dimension.GetRows() && width == dimension.GetCols())
+				{
+					range = std::move(dimension);
+					return true;
+				}
+				range = CXlsxRange(height, width);
+				for (size_t i = 0; i < height; i++)
+				{
+					for (size_t j = 0; j < width; j++)
+						range(i, j).swap(dimension(top + i, left + j));
+				}
+				return true;
+			}
+
+			std::vector<std::vector<std::string>>& cells = handler.cells;
+			range = CXlsxRange(height, width);
+			for (size_t i = firstRow; i < cells.size(); i++)
+			{
+				std::vector<std::string>& cellsRow = cells[i];
+				size_t count = cellsRow.size() > firstCol ? std::min(cellsRow.size() - firstCol, width) : 0;
+				for (size_t j = 0; j < count; j++)
+					range(i - firstRow, j).swap(cellsRow[firstCol + j]);
+				std::vector<std::string>().swap(cellsRow);
+			}
+			return true;
+		}
+
+		// number of non-empty cells read by the last GetUsedRange() call
+		size_t GetCellsCount() const
+		{
+			return m_cellsCount;
+		}
+
+		// zero-based indexes of the top left cell of the range read by the last GetUsedRange() call
+		size_t GetFirstRow() const
+		{
+			return m_firstRow;
+		}
+
+		size_t GetFirstCol() const
+		{
+			return m_firstCol;
+		}
+	};
+}
+
+#endif // SAMPLES_UTILS_XLSX_READER_H